@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include "FootprintCache.h"
+
+
+FootprintCache::FootprintCache(const std::string& memtrace_filepath,
+        uint64_t line_size, uint64_t page_size) :
+        memtrace_filepath(memtrace_filepath), line_size(line_size),
+        page_size(page_size)
+{
+    // (next to the trace, one per line and page size)
+    std::filesystem::path path(memtrace_filepath);
+    filepath = (path.parent_path() / (path.stem().string() + ".footprint-" +
+            std::to_string(line_size) + "-" + std::to_string(page_size) +
+            ".bin")).string();
+
+    compute_key();
+}
+
+
+FootprintCache::~FootprintCache()
+{
+}
+
+
+/*
+ * The trace's size and modification time, plus an FNV-1a hash of its first
+ * and last N_HASH_BYTES (and not the whole thing, which would cost as much
+ * I/O as the pass the sidecar saves).
+ */
+void
+FootprintCache::compute_key()
+{
+    std::error_code ec;
+    trace_n_bytes = std::filesystem::file_size(memtrace_filepath, ec);
+    if (ec) return;
+    trace_mtime = std::filesystem::last_write_time(memtrace_filepath, ec).
+            time_since_epoch().count();
+
+    std::ifstream ifs(memtrace_filepath, std::ios::binary);
+    std::vector<char> buf(std::min(trace_n_bytes, N_HASH_BYTES));
+
+    trace_hash = 0xcbf29ce484222325;
+    auto hash_range = [&](uint64_t offset) {
+        ifs.seekg(offset, std::ios_base::beg);
+        ifs.read(buf.data(), buf.size());
+        for (char c : buf) {
+            trace_hash ^= (uint8_t) c;
+            trace_hash *= 0x100000001b3;
+        }
+    };
+    hash_range(0);
+    hash_range(trace_n_bytes - buf.size());
+}
+
+
+bool
+FootprintCache::load(footprint_t& fp)
+{
+    std::ifstream ifs(filepath, std::ios::binary);
+    if (!ifs.is_open()) return false;
+
+    header_t h;
+    if (!ifs.read((char*) &h, sizeof(h))) return false;
+    if (h.magic != MAGIC or h.version != VERSION or
+            h.trace_n_bytes != trace_n_bytes or
+            h.trace_mtime != trace_mtime or h.trace_hash != trace_hash or
+            h.line_size != line_size or h.page_size != page_size)
+        return false;
+
+    // (don't trust n_pages to size anything before checking the file's size)
+    std::error_code ec;
+    uint64_t n_bytes = std::filesystem::file_size(filepath, ec);
+    if (ec or n_bytes != sizeof(h) + h.n_pages * (sizeof(page_addr_t) +
+            sizeof(uint8_t)))
+        return false;
+
+    fp.n_accesses = h.n_accesses;
+    fp.n_writes = h.n_writes;
+    fp.pages.resize(h.n_pages);
+    fp.page_written.resize(h.n_pages);
+    ifs.read((char*) fp.pages.data(), h.n_pages * sizeof(page_addr_t));
+    ifs.read((char*) fp.page_written.data(), h.n_pages * sizeof(uint8_t));
+    return (bool) ifs;
+}
+
+
+/*
+ * Write via a temporary file and rename it into place, so that concurrent
+ * runs on the same trace never read a partial sidecar.
+ */
+bool
+FootprintCache::save(const footprint_t& fp)
+{
+    header_t h = {MAGIC, VERSION, trace_n_bytes, trace_mtime, trace_hash,
+            line_size, page_size, fp.n_accesses, fp.n_writes,
+            fp.pages.size()};
+
+    std::string tmp_filepath = filepath + ".tmp";
+    bool ok;
+    {
+        std::ofstream ofs(tmp_filepath, std::ofstream::out |
+                std::ofstream::binary | std::ofstream::trunc);
+        ofs.write((const char*) &h, sizeof(h));
+        ofs.write((const char*) fp.pages.data(),
+                fp.pages.size() * sizeof(page_addr_t));
+        ofs.write((const char*) fp.page_written.data(),
+                fp.page_written.size() * sizeof(uint8_t));
+        ofs.flush();
+        ok = (bool) ofs;
+    }
+
+    std::error_code ec;
+    if (!ok) {
+        std::filesystem::remove(tmp_filepath, ec);
+        return false;
+    }
+    std::filesystem::rename(tmp_filepath, filepath, ec);
+    return !ec;
+}
+
+
+uint64_t
+FootprintCache::get_n_write_pages(const footprint_t& fp)
+{
+    return std::count(fp.page_written.begin(), fp.page_written.end(), 1);
+}
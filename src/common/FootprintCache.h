@@ -0,0 +1,90 @@
+/*
+ * Sidecar cache of a memtrace.bin file's page footprint at one line and page
+ * size: its distinct pages, in first-touch order, which of those are ever
+ * written, and its access and write counts. Written by the first tool that
+ * decodes the trace in full, next to the trace, and read back by later runs
+ * (of any tool), so that they know the footprint (e.g., to size memory and
+ * pre-size tables) before, or without, a pass over the trace.
+ * A sidecar is keyed by the trace's size, modification time and a hash of its
+ * head and tail, and is ignored if any of those no longer match.
+ */
+#pragma once
+
+#include <cstdbool>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "defs.h"
+
+
+typedef struct {
+    uint64_t n_accesses = 0;
+    uint64_t n_writes = 0;
+    // distinct pages, in the order the trace first touches them
+    std::vector<page_addr_t> pages;
+    // by index into pages: whether the page is ever written
+    std::vector<uint8_t> page_written;
+} footprint_t;
+
+
+class FootprintCache {
+    public:
+        FootprintCache(const std::string& memtrace_filepath,
+                uint64_t line_size, uint64_t page_size);
+        FootprintCache(const FootprintCache& fc) = delete;
+        FootprintCache& operator=(const FootprintCache& fc) = delete;
+        FootprintCache(FootprintCache&& fc) = delete;
+        FootprintCache& operator=(FootprintCache&& fc) = delete;
+        ~FootprintCache();
+
+        // returns true iff a sidecar matching the trace was read into fp
+        bool load(footprint_t& fp);
+        // (failing to write it is not fatal; returns false)
+        bool save(const footprint_t& fp);
+        inline const std::string& get_filepath();
+
+        static uint64_t get_n_write_pages(const footprint_t& fp);
+
+        // identifies the format; bump the version on any layout change
+        static constexpr uint64_t MAGIC = 0x31505446434d454d;  // "MEMCFTP1"
+        static constexpr uint64_t VERSION = 1;
+        // bytes hashed at each end of the trace
+        static constexpr uint64_t N_HASH_BYTES = 1048576;
+
+    private:
+        typedef struct {
+            uint64_t magic;
+            uint64_t version;
+            uint64_t trace_n_bytes;
+            uint64_t trace_mtime;
+            uint64_t trace_hash;
+            uint64_t line_size;
+            uint64_t page_size;
+            uint64_t n_accesses;
+            uint64_t n_writes;
+            uint64_t n_pages;
+        } header_t;
+
+        void compute_key();
+
+        std::string memtrace_filepath;
+        std::string filepath;
+        uint64_t line_size;
+        uint64_t page_size;
+
+        // derived
+        uint64_t trace_n_bytes = 0;
+        uint64_t trace_mtime = 0;
+        uint64_t trace_hash = 0;
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline const std::string&
+FootprintCache::get_filepath()
+{
+    return filepath;
+}
@@ -0,0 +1,71 @@
+/*
+ * NOTE: many member functions are declared as inline and defined in the
+ * accompanying .h file.
+ */
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "HyperLogLog.h"
+
+
+HyperLogLog::HyperLogLog(uint64_t precision) : precision(precision)
+{
+    if (precision < MIN_PRECISION or precision > MAX_PRECISION)
+        throw std::runtime_error("HyperLogLog precision out of range");
+
+    n_registers = (uint64_t) 1 << precision;
+    registers.resize(n_registers, 0);
+}
+
+
+HyperLogLog::~HyperLogLog()
+{
+}
+
+
+/*
+ * Fold another sketch (of the same precision) into this one; the result
+ * estimates the cardinality of the union of both streams.
+ */
+void
+HyperLogLog::merge(const HyperLogLog& hll)
+{
+    if (hll.precision != precision)
+        throw std::runtime_error("cannot merge HyperLogLogs of differing "
+                "precision");
+
+    for (uint64_t i = 0; i < n_registers; ++i) {
+        if (hll.registers[i] > registers[i]) registers[i] = hll.registers[i];
+    }
+}
+
+
+double
+HyperLogLog::estimate() const
+{
+    double m = (double) n_registers;
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    double sum = 0.0;
+    uint64_t n_zero_registers = 0;
+    for (auto r : registers) {
+        sum += std::ldexp(1.0, -r);
+        if (r == 0) ++n_zero_registers;
+    }
+
+    double e = alpha * m * m / sum;
+
+    // small-range correction: fall back to linear counting
+    if (e <= 2.5 * m and n_zero_registers != 0)
+        e = m * std::log(m / (double) n_zero_registers);
+
+    return e;
+}
+
+
+void
+HyperLogLog::clear()
+{
+    std::fill(registers.begin(), registers.end(), 0);
+}
@@ -0,0 +1,66 @@
+/*
+ * HyperLogLog cardinality sketch, for estimating the number of distinct keys
+ * (e.g., line or page addresses) in a stream in fixed memory: 2^precision
+ * one-byte registers, with a relative standard error of ~1.04/sqrt(2^p).
+ * NOTE: many member functions are declared as inline and defined in this .h
+ * file.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+class HyperLogLog {
+    public:
+        HyperLogLog(uint64_t precision = DEFAULT_PRECISION);
+        HyperLogLog(const HyperLogLog& hll) = default;
+        HyperLogLog& operator=(const HyperLogLog& hll) = default;
+        HyperLogLog(HyperLogLog&& hll) = default;
+        HyperLogLog& operator=(HyperLogLog&& hll) = default;
+        ~HyperLogLog();
+
+        inline void add(uint64_t key);
+        void merge(const HyperLogLog& hll);
+        double estimate() const;
+        void clear();
+
+        static constexpr uint64_t DEFAULT_PRECISION = 14;
+        static constexpr uint64_t MIN_PRECISION = 4;
+        static constexpr uint64_t MAX_PRECISION = 18;
+
+    private:
+        static inline uint64_t hash(uint64_t key);
+
+        uint64_t precision;
+        uint64_t n_registers;
+        std::vector<uint8_t> registers;
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline uint64_t
+HyperLogLog::hash(uint64_t key)
+{
+    // splitmix64 finalizer; addresses are far from uniformly distributed
+    key += 0x9e3779b97f4a7c15;
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111eb;
+    return key ^ (key >> 31);
+}
+
+
+inline void
+HyperLogLog::add(uint64_t key)
+{
+    uint64_t h = hash(key);
+    uint64_t idx = h >> (64 - precision);
+    // rank of the first set bit in the remaining (64 - precision) bits; the
+    // sentinel bit bounds it when they are all zero
+    uint64_t rest = (h << precision) | ((uint64_t) 1 << (precision - 1));
+    uint8_t rank = __builtin_clzll(rest) + 1;
+
+    if (rank > registers[idx]) registers[idx] = rank;
+}
@@ -67,6 +67,19 @@ MemTraceReader::load(const std::string& input_filepath)
 }
 
 
+/*
+ * Close the trace file and free the trace buffer, for users that are done
+ * reading the trace (e.g., after copying what they need out of it).
+ */
+void
+MemTraceReader::unload()
+{
+    if (ifs.is_open()) ifs.close();
+    delete[] buf;
+    buf = nullptr;
+}
+
+
 void
 MemTraceReader::get_first_entry(memtrace_entry_t& entry)
 {
@@ -31,6 +31,7 @@ class MemTraceReader {
         MemTraceReader();
         ~MemTraceReader();
         void load(const std::string& input_filepath);
+        void unload();
         inline memtrace_entry_t& next();
         inline bool is_end_of_buffer();
         inline bool is_end_of_pass();
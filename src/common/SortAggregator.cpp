@@ -0,0 +1,96 @@
+/*
+ * NOTE: many member functions are declared as inline and defined in the
+ * accompanying .h file.
+ */
+#include "SortAggregator.h"
+
+
+SortAggregator::SortAggregator(ThreadPool& pool, size_t chunk_n_keys) :
+        pool(pool), chunk_n_keys(chunk_n_keys)
+{
+    chunk.reserve(chunk_n_keys);
+}
+
+
+SortAggregator::~SortAggregator()
+{
+}
+
+
+/*
+ * Sort and run-length encode whatever keys are left in the current chunk.
+ * After this, get_counts() holds the complete aggregate, sorted by key.
+ */
+void
+SortAggregator::finalize()
+{
+    if (!chunk.empty()) flush();
+
+    // release the chunk buffer
+    std::vector<uint64_t>().swap(chunk);
+}
+
+
+/*
+ * Sort the current chunk, run-length encode it, and merge the resulting
+ * (key, count) pairs into the running aggregate.
+ */
+void
+SortAggregator::flush()
+{
+    parallel_radix_sort(chunk, [](uint64_t k) { return k; }, pool);
+
+    std::vector<key_count_t> runs;
+    for (size_t i = 0; i < chunk.size(); ) {
+        size_t j = i + 1;
+        while (j < chunk.size() and chunk[j] == chunk[i]) ++j;
+        runs.push_back({chunk[i], j - i});
+        i = j;
+    }
+    chunk.clear();
+
+    if (counts.empty()) {
+        counts = std::move(runs);
+        return;
+    }
+
+    // two-way merge, summing the counts of keys present in both
+    std::vector<key_count_t> merged;
+    merged.reserve(counts.size() + runs.size());
+    size_t a = 0, b = 0;
+    while (a < counts.size() and b < runs.size()) {
+        if (counts[a].key < runs[b].key) merged.emplace_back(counts[a++]);
+        else if (runs[b].key < counts[a].key) merged.emplace_back(runs[b++]);
+        else {
+            merged.push_back({counts[a].key, counts[a].count + runs[b].count});
+            ++a;
+            ++b;
+        }
+    }
+    while (a < counts.size()) merged.emplace_back(counts[a++]);
+    while (b < runs.size()) merged.emplace_back(runs[b++]);
+
+    counts = std::move(merged);
+}
+
+
+/*
+ * Given aggregated counts sorted by key, re-aggregate them at a coarser
+ * granularity (key >> shift); e.g., line counts into page counts. Since the
+ * input is sorted, so is the output.
+ */
+std::vector<key_count_t>
+SortAggregator::coarsen(const std::vector<key_count_t>& counts, uint64_t shift)
+{
+    std::vector<key_count_t> coarse;
+
+    for (auto& kc : counts) {
+        uint64_t coarse_key = kc.key >> shift;
+        if (!coarse.empty() and coarse.back().key == coarse_key) {
+            coarse.back().count += kc.count;
+        }
+        else coarse.push_back({coarse_key, kc.count});
+    }
+
+    return coarse;
+}
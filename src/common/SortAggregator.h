@@ -0,0 +1,174 @@
+/*
+ * Sort-based aggregation, as an alternative to counting keys (e.g., line or
+ * page addresses) with millions of random unordered_map updates. Keys are
+ * buffered into fixed-size chunks; each chunk is sorted with a parallel LSD
+ * radix sort, run-length encoded into (key, count) pairs, and merged into the
+ * running (sorted) aggregate.
+ * NOTE: the radix sort is templated, and so is declared inline and defined in
+ * this .h file.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ThreadPool.h"
+
+
+typedef struct {
+    uint64_t key;
+    uint64_t count;
+} key_count_t;
+
+
+template <typename T, typename KeyFn>
+inline void parallel_radix_sort(std::vector<T>& v, KeyFn key_fn,
+        ThreadPool& pool);
+
+
+class SortAggregator {
+    public:
+        SortAggregator(ThreadPool& pool,
+                size_t chunk_n_keys = DEFAULT_CHUNK_N_KEYS);
+        SortAggregator(const SortAggregator& sa) = delete;
+        SortAggregator& operator=(const SortAggregator& sa) = delete;
+        SortAggregator(SortAggregator&& sa) = delete;
+        SortAggregator& operator=(SortAggregator&& sa) = delete;
+        ~SortAggregator();
+
+        inline void add(uint64_t key);
+        void finalize();
+        inline std::vector<key_count_t>& get_counts();
+
+        // static helper methods
+        static std::vector<key_count_t> coarsen(
+                const std::vector<key_count_t>& counts, uint64_t shift);
+
+    private:
+        void flush();
+
+        // default chunk size: 16Mi keys (128 MiB)
+        static constexpr size_t DEFAULT_CHUNK_N_KEYS = 16777216;
+
+        ThreadPool& pool;
+        size_t chunk_n_keys;
+        std::vector<uint64_t> chunk;
+        std::vector<key_count_t> counts;
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline void
+SortAggregator::add(uint64_t key)
+{
+    chunk.emplace_back(key);
+    if (chunk.size() == chunk_n_keys) flush();
+}
+
+
+inline std::vector<key_count_t>&
+SortAggregator::get_counts()
+{
+    return counts;
+}
+
+
+/*
+ * Single-threaded LSD radix sort of src[0, n), 8 bits per digit, using tmp as
+ * scratch space. Digits in which every key is identical (e.g., the high bytes
+ * of addresses) are skipped entirely. Stable.
+ */
+template <typename T, typename KeyFn>
+inline void
+radix_sort_range(T* src, T* tmp, size_t n, KeyFn key_fn)
+{
+    if (n < 2) return;
+
+    // build all eight digit histograms in one scan
+    size_t hist[8][256] = {};
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t k = key_fn(src[i]);
+        for (size_t d = 0; d < 8; ++d) ++hist[d][(k >> (8 * d)) & 0xff];
+    }
+
+    T* in = src;
+    T* out = tmp;
+    for (size_t d = 0; d < 8; ++d) {
+        size_t shift = 8 * d;
+        if (hist[d][(key_fn(in[0]) >> shift) & 0xff] == n) continue;
+
+        size_t offsets[256];
+        size_t sum = 0;
+        for (size_t b = 0; b < 256; ++b) {
+            offsets[b] = sum;
+            sum += hist[d][b];
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            out[offsets[(key_fn(in[i]) >> shift) & 0xff]++] = in[i];
+        }
+        std::swap(in, out);
+    }
+
+    if (in != src) std::copy(in, in + n, src);
+}
+
+
+/*
+ * Chunked parallel LSD radix sort: each worker radix-sorts its own contiguous
+ * chunk, and the sorted chunks are then combined with rounds of pairwise
+ * (parallel) merges. Stable, so equal keys keep their input order.
+ */
+template <typename T, typename KeyFn>
+inline void
+parallel_radix_sort(std::vector<T>& v, KeyFn key_fn, ThreadPool& pool)
+{
+    // don't bother splitting below this many elements per chunk
+    static constexpr size_t MIN_CHUNK_N_ELEMS = 65536;
+
+    size_t n = v.size();
+    if (n < 2) return;
+
+    size_t n_chunks = std::min(pool.get_n_threads(),
+            (n + MIN_CHUNK_N_ELEMS - 1) / MIN_CHUNK_N_ELEMS);
+    n_chunks = std::max(n_chunks, (size_t) 1);
+
+    std::vector<size_t> bounds(n_chunks + 1);
+    for (size_t i = 0; i <= n_chunks; ++i) bounds[i] = (n * i) / n_chunks;
+
+    std::vector<T> tmp(n);
+
+    pool.parallel_for(n_chunks, [&](size_t i) {
+        radix_sort_range(v.data() + bounds[i], tmp.data() + bounds[i],
+                bounds[i + 1] - bounds[i], key_fn);
+    });
+
+    // merge adjacent runs until only one remains
+    auto cmp = [&key_fn](const T& a, const T& b) {
+        return key_fn(a) < key_fn(b);
+    };
+    while (bounds.size() > 2) {
+        size_t n_runs = bounds.size() - 1;
+        size_t n_pairs = (n_runs + 1) / 2;
+
+        pool.parallel_for(n_pairs, [&](size_t p) {
+            size_t lo = bounds[2 * p];
+            size_t mid = bounds[std::min(2 * p + 1, n_runs)];
+            size_t hi = bounds[std::min(2 * p + 2, n_runs)];
+            std::merge(v.begin() + lo, v.begin() + mid, v.begin() + mid,
+                    v.begin() + hi, tmp.begin() + lo, cmp);
+        });
+        std::swap(v, tmp);
+
+        std::vector<size_t> new_bounds;
+        for (size_t i = 0; i < bounds.size(); i += 2) {
+            new_bounds.emplace_back(bounds[i]);
+        }
+        if (new_bounds.back() != n) new_bounds.emplace_back(n);
+        bounds = std::move(new_bounds);
+    }
+}
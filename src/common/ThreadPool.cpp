@@ -0,0 +1,94 @@
+#include <cstdlib>
+
+#include "ThreadPool.h"
+#include "util.h"
+
+
+ThreadPool::ThreadPool(size_t n_threads)
+{
+    if (n_threads == 0) {
+        char* requested_n_threads_str = std::getenv("TRACEPROC_N_THREADS");
+        n_threads = requested_n_threads_str ?
+                shorthand_to_integer(requested_n_threads_str, 1000) :
+                std::thread::hardware_concurrency();
+    }
+    // hardware_concurrency() may return 0 if it can't tell
+    if (n_threads == 0) n_threads = 1;
+
+    for (size_t i = 0; i < n_threads; ++i) {
+        workers.emplace_back(&ThreadPool::worker_loop, this);
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    task_cv.notify_all();
+
+    for (auto& w : workers) w.join();
+}
+
+
+void
+ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        tasks.emplace(std::move(task));
+        ++n_outstanding;
+    }
+    task_cv.notify_one();
+}
+
+
+/*
+ * Block until every task submitted so far has finished executing.
+ */
+void
+ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    done_cv.wait(lock, [this] { return n_outstanding == 0; });
+}
+
+
+/*
+ * Run fn(0), fn(1), ..., fn(n - 1) across the workers, and return once all of
+ * them have completed.
+ */
+void
+ThreadPool::parallel_for(size_t n, const std::function<void(size_t)>& fn)
+{
+    for (size_t i = 0; i < n; ++i) {
+        submit([&fn, i] { fn(i); });
+    }
+    wait();
+}
+
+
+void
+ThreadPool::worker_loop()
+{
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            task_cv.wait(lock, [this] { return stopping or !tasks.empty(); });
+            if (stopping and tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+
+        task();
+
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            --n_outstanding;
+            if (n_outstanding == 0) done_cv.notify_all();
+        }
+    }
+}
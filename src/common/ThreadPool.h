@@ -0,0 +1,53 @@
+/*
+ * Simple fixed-size pool of worker threads, shared by the tools that
+ * parallelize over chunks of a trace or over independent simulations.
+ * The number of workers defaults to the hardware concurrency, and may be
+ * overridden via the TRACEPROC_N_THREADS environment variable.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+
+class ThreadPool {
+    public:
+        ThreadPool(size_t n_threads = 0);
+        ThreadPool(const ThreadPool& tp) = delete;
+        ThreadPool& operator=(const ThreadPool& tp) = delete;
+        ThreadPool(ThreadPool&& tp) = delete;
+        ThreadPool& operator=(ThreadPool&& tp) = delete;
+        ~ThreadPool();
+
+        void submit(std::function<void()> task);
+        void wait();
+        void parallel_for(size_t n, const std::function<void(size_t)>& fn);
+        inline size_t get_n_threads();
+
+    private:
+        void worker_loop();
+
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex mtx;
+        std::condition_variable task_cv;
+        std::condition_variable done_cv;
+        size_t n_outstanding = 0;
+        bool stopping = false;
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline size_t
+ThreadPool::get_n_threads()
+{
+    return workers.size();
+}
@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+#include "../common/util.h"
+#include "Footprint.h"
+
+
+
+Footprint::Footprint(int argc, char* argv[])
+{
+    parse_and_validate_args(argc, argv);
+
+    global_sketches = std::make_unique<sketches_t>(precision);
+
+    std::string memtrace_filepath = memtrace_directory + "/" + "memtrace.bin";
+    mtr.load(memtrace_filepath);
+
+    FootprintCache footprint_cache(memtrace_filepath, line_size, page_size);
+    footprint_cached = footprint_cache.load(footprint);
+
+    window_ofs.open("footprint-windows.txt", std::ofstream::out);
+    window_ofs << "WINDOW_IDX" << " " << "N_ACCESSES" << " " << "LINES" <<
+            " " << "PAGES" << " " << "CUMULATIVE_LINES" << " " <<
+            "CUMULATIVE_PAGES" << std::endl;
+
+    node_window_ofs.open("footprint-windows-nodes.txt", std::ofstream::out);
+    node_window_ofs << "WINDOW_IDX" << " " << "NODE" << " " << "N_ACCESSES" <<
+            " " << "LINES" << " " << "PAGES" << " " << "CUMULATIVE_LINES" <<
+            " " << "CUMULATIVE_PAGES" << std::endl;
+}
+
+
+Footprint::~Footprint()
+{
+}
+
+
+void
+Footprint::parse_and_validate_args(int argc, char* argv[])
+{
+    int c;
+    optind = 0; // global: clear previous getopt() state, if any
+    opterr = 0; // global: don't explicitly warn on unrecognized args
+    int n_args_parsed = 0;
+
+    // sentinels
+    memtrace_directory = "";
+    line_size = 0;
+    page_size = 0;
+    window_cycles = 0;
+    // (optional)
+    precision = HyperLogLog::DEFAULT_PRECISION;
+
+    // parse
+    while ((c = getopt(argc, argv, "m:l:p:w:b:")) != -1) {
+        try {
+            switch (c) {
+                case 'm':
+                    memtrace_directory = optarg;
+                    break;
+                case 'l':
+                    line_size = shorthand_to_integer(optarg, 1024);
+                    break;
+                case 'p':
+                    page_size = shorthand_to_integer(optarg, 1024);
+                    break;
+                case 'w':
+                    window_cycles = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'b':
+                    precision = std::stoull(optarg);
+                    break;
+                case '?':
+                    print_message_and_die("unrecognized argument");
+            }
+        }
+        catch (...) {
+            print_message_and_die("generic arg parse failure");
+        }
+        ++n_args_parsed;
+    }
+
+
+    // and validate
+    // the executable itself (1) plus each arg matched w/its preceding flag (*2)
+    int argc_expected = 1 + (2 * n_args_parsed);
+    if (argc != argc_expected)
+        print_message_and_die("each argument must be accompanied by a flag");
+
+    if (memtrace_directory == "")
+        print_message_and_die("must supply MemTrace input directory (-m)");
+
+    if (line_size == 0)
+        print_message_and_die("must supply line size (-l)");
+
+    if (page_size == 0)
+        print_message_and_die("must supply page size (-p)");
+
+    if (line_size > page_size)
+        print_message_and_die("line size (-l) must be <= page size (-p)");
+
+    if (__builtin_popcountll(line_size) != 1)
+        print_message_and_die("line size (-l) must be a power of 2");
+
+    if (__builtin_popcountll(page_size) != 1)
+        print_message_and_die("page size (-p) must be a power of 2");
+
+    if (window_cycles == 0)
+        print_message_and_die("must supply window size in cycles (-w)");
+
+    if (precision < HyperLogLog::MIN_PRECISION or
+            precision > HyperLogLog::MAX_PRECISION)
+        print_message_and_die("HyperLogLog precision (-b) must be in [%zu, "
+                "%zu]", HyperLogLog::MIN_PRECISION,
+                HyperLogLog::MAX_PRECISION);
+
+
+    line_size_log2 = __builtin_ctzll(line_size);
+    page_size_log2 = __builtin_ctzll(page_size);
+}
+
+
+void
+Footprint::run()
+{
+    while (!mtr.is_end_of_pass()) {
+        auto& mt = mtr.next();
+        line_addr_t line_addr = mt.line_addr;
+        page_addr_t page_addr = line_addr_to_page_addr(line_addr,
+                line_size_log2, page_size_log2);
+        node_id_t node = mt.node_num;
+
+        // NOTE: as in SNStats, an access with a cycle that falls into an
+        // already-emitted window is attributed to the current window
+        uint64_t window_idx = mt.cycle / window_cycles;
+        if (window_idx > curr_window_idx) {
+            flush_window();
+            curr_window_idx = window_idx;
+        }
+
+        while (node_sketches.size() <= node) {
+            node_sketches.emplace_back(precision);
+        }
+
+        add(*global_sketches, line_addr, page_addr);
+        add(node_sketches[node], line_addr, page_addr);
+    }
+
+    // emit the final (partial) window
+    flush_window();
+}
+
+
+/*
+ * Emit the current window's estimates, fold its sketches into the
+ * whole-trace ones, and reset them. Windows (and nodes within a window) with
+ * no accesses are skipped.
+ */
+void
+Footprint::flush_window()
+{
+    if (global_sketches->window_n_accesses == 0) return;
+
+    auto flush = [](sketches_t& s) {
+        s.total_lines.merge(s.window_lines);
+        s.total_pages.merge(s.window_pages);
+    };
+
+    flush(*global_sketches);
+    window_ofs << curr_window_idx << " " <<
+            global_sketches->window_n_accesses << " " <<
+            std::llround(global_sketches->window_lines.estimate()) << " " <<
+            std::llround(global_sketches->window_pages.estimate()) << " " <<
+            std::llround(global_sketches->total_lines.estimate()) << " " <<
+            std::llround(global_sketches->total_pages.estimate()) << std::endl;
+
+    for (size_t i = 0; i < node_sketches.size(); ++i) {
+        auto& s = node_sketches[i];
+        if (s.window_n_accesses == 0) continue;
+
+        flush(s);
+        node_window_ofs << curr_window_idx << " " << i << " " <<
+                s.window_n_accesses << " " <<
+                std::llround(s.window_lines.estimate()) << " " <<
+                std::llround(s.window_pages.estimate()) << " " <<
+                std::llround(s.total_lines.estimate()) << " " <<
+                std::llround(s.total_pages.estimate()) << std::endl;
+
+        s.window_lines.clear();
+        s.window_pages.clear();
+        s.window_n_accesses = 0;
+    }
+
+    global_sketches->window_lines.clear();
+    global_sketches->window_pages.clear();
+    global_sketches->window_n_accesses = 0;
+
+    ++n_windows_emitted;
+}
+
+
+void
+Footprint::dump_termination_stats()
+{
+    double line_footprint = global_sketches->total_lines.estimate();
+    double page_footprint = global_sketches->total_pages.estimate();
+
+    double max_node_page_footprint = 0.0;
+    for (auto& s : node_sketches) {
+        max_node_page_footprint = std::max(max_node_page_footprint,
+                s.total_pages.estimate());
+    }
+
+    // using a stringstream, dump to both file and stdout
+    std::stringstream ss;
+
+    ss << "LINE_SIZE" << " " << line_size << std::endl;
+    ss << "PAGE_SIZE" << " " << page_size << std::endl;
+    ss << "WINDOW_CYCLES" << " " << window_cycles << std::endl;
+    ss << "HLL_PRECISION" << " " << precision << std::endl;
+    ss << "N_WINDOWS" << " " << n_windows_emitted << std::endl;
+    ss << "N_NODES" << " " << node_sketches.size() << std::endl;
+    ss << "LINE_FOOTPRINT_EST" << " " << std::llround(line_footprint) <<
+            std::endl;
+    ss << "PAGE_FOOTPRINT_EST" << " " << std::llround(page_footprint) <<
+            std::endl;
+    ss << "PAGE_FOOTPRINT_BYTES_EST" << " " <<
+            std::llround(page_footprint) * page_size << std::endl;
+    ss << "MAX_NODE_PAGE_FOOTPRINT_EST" << " " <<
+            std::llround(max_node_page_footprint) << std::endl;
+    ss << "MAX_NODE_PAGE_FOOTPRINT_BYTES_EST" << " " <<
+            std::llround(max_node_page_footprint) * page_size << std::endl;
+    if (footprint_cached) {
+        ss << "PAGE_FOOTPRINT" << " " << footprint.pages.size() << std::endl;
+        ss << "PAGE_FOOTPRINT_BYTES" << " " <<
+                footprint.pages.size() * page_size << std::endl;
+        ss << "WRITE_PAGE_FOOTPRINT" << " " <<
+                FootprintCache::get_n_write_pages(footprint) << std::endl;
+    }
+
+    std::cout << ss.rdbuf()->str();
+
+    std::ofstream ofs("footprint.txt", std::ofstream::out);
+    ofs << ss.rdbuf()->str();
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    Footprint fp(argc, argv);
+
+    fp.run();
+    fp.dump_termination_stats();
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+/*
+ * Lightweight footprint / working-set-size analysis. In one streaming pass,
+ * and in fixed memory regardless of trace length, estimates the number of
+ * distinct lines and pages touched, both overall and per fixed window of
+ * cycles, for the whole trace and for each node, using HyperLogLog sketches.
+ * Useful for sizing -g in SNQueues (whole trace) and MNQueues (per node).
+ * If the trace's exact page footprint has been cached (see FootprintCache.h)
+ * at the same line and page size, that is reported as well.
+ */
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../common/defs.h"
+#include "../common/FootprintCache.h"
+#include "../common/HyperLogLog.h"
+#include "../common/MemTraceReader.h"
+
+
+class Footprint {
+    public:
+        Footprint(int argc, char* argv[]);
+        Footprint(const Footprint& fp) = delete;
+        Footprint& operator=(const Footprint& fp) = delete;
+        Footprint(Footprint&& fp) = delete;
+        Footprint& operator=(Footprint&& fp) = delete;
+        ~Footprint();
+
+        void run();
+        void dump_termination_stats();
+
+
+    private:
+        // window and whole-trace sketches for one scope (global, or a node)
+        typedef struct sketches_t {
+            sketches_t(uint64_t precision) : window_lines(precision),
+                    window_pages(precision), total_lines(precision),
+                    total_pages(precision) { }
+
+            HyperLogLog window_lines;
+            HyperLogLog window_pages;
+            HyperLogLog total_lines;
+            HyperLogLog total_pages;
+            uint64_t window_n_accesses = 0;
+        } sketches_t;
+
+        void parse_and_validate_args(int argc, char* argv[]);
+        inline void add(sketches_t& s, line_addr_t line_addr,
+                page_addr_t page_addr);
+        void flush_window();
+
+        // input arguments
+        std::string memtrace_directory;
+        uint64_t line_size;
+        uint64_t page_size;
+        uint64_t window_cycles;
+        uint64_t precision;
+
+        // derived, or from input files
+        MemTraceReader mtr;
+        uint64_t line_size_log2;
+        uint64_t page_size_log2;
+        bool footprint_cached = false;
+        footprint_t footprint;
+
+        // internal mechanics
+        std::vector<sketches_t> node_sketches;
+        std::unique_ptr<sketches_t> global_sketches;
+        uint64_t curr_window_idx = 0;
+        uint64_t n_windows_emitted = 0;
+        std::ofstream window_ofs;
+        std::ofstream node_window_ofs;
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline void
+Footprint::add(sketches_t& s, line_addr_t line_addr, page_addr_t page_addr)
+{
+    s.window_lines.add(line_addr);
+    s.window_pages.add(page_addr);
+    ++s.window_n_accesses;
+}
@@ -2,9 +2,11 @@
 #include <cassert>
 #include <cstdbool>
 #include <cstdio>
+#include <functional>
 #include <iterator>
 #include <filesystem>
 #include <iostream>
+#include <queue>
 #include <regex>
 #include <sstream>
 
@@ -127,11 +129,13 @@ MNQueues::parse_and_validate_args(int argc, char* argv[])
     page_size = 0;
     scheduler_quanta_s = 0.0;
     rebalance = -1;
+    // (optional; defaults to on)
+    event_driven = 1;
     jobs_str = "";
 
 
     // parse
-    while ((c = getopt(argc, argv, "n:c:l:p:i:e:g:t:r:j:")) != -1) {
+    while ((c = getopt(argc, argv, "n:c:l:p:i:e:g:t:r:f:j:")) != -1) {
         try {
             switch (c) {
                 case 'n':
@@ -162,6 +166,9 @@ MNQueues::parse_and_validate_args(int argc, char* argv[])
                 case 'r':
                     rebalance = string_to_boolean(optarg);
                     break;
+                case 'f':
+                    event_driven = string_to_boolean(optarg);
+                    break;
                 case 'j':
                     jobs_str = optarg;
                     // also parse into the vector here
@@ -222,6 +229,9 @@ MNQueues::parse_and_validate_args(int argc, char* argv[])
         print_message_and_die("must supply whether/not to perform rotation/"
                 "rebalancing (-r)");
 
+    if (event_driven == -1)
+        print_message_and_die("could not parse event-driven mode (-f)");
+
     if (jobs_str == "")
         print_message_and_die("must supply jobs str., of the form "
                 "WBW0:WF0,WBW1:WF1,... (-j)");
@@ -243,7 +253,7 @@ MNQueues::run_rebalance()
     for (node_id_t i = 0; i < n_nodes; ++i) {
         // allocate everything in the bottommost queue initially
         // job i maps to node i initially
-        node_meta_t* nm = new node_meta_t{0, 0, 0, i};
+        node_meta_t* nm = new node_meta_t{0, 0, 0, i, NO_EPOCH};
         queues_vec[0].emplace_back(nm);
         auto lq_back = std::next(queues_vec[0].end(), -1);
         // and the job map
@@ -257,132 +267,290 @@ MNQueues::run_rebalance()
 
 
     // main loop
-    bool cont = true;
-    for (epoch = 0; epoch < n_iterations and cont; ++epoch) {
+    if (event_driven) {
+        run_event_driven();
+        return;
+    }
 
+    bool cont = true;
+    while (epoch < n_iterations and cont) {
         // print some statistics
-        if ((epoch + 1) % (uint64_t) 100000000 == 0)
+        if ((epoch + 1) % N_EPOCHS_PER_STATS_DUMP == 0)
             dump_stats(false /* incremental, not final */);
 
-        for (auto& j : jobs) {
-            // find out what node this job is currently mapped to
-            auto nmi = job_map[j.idx];
-            node_meta_t* nm = *nmi;
-
-            if (nm->interval_bfs > bucket_interval) {
-                // node has hit its write interval.
-                // 1. promote the node into the next-higher queue
-                // 2. in the lowest active queue, "rotate" the head node with
-                //    the tail node
-                // 3. swap the contents of the new tail node in the lowest
-                //    queue with the promoted node
-                // NOTE: we do account for extra writes incurred by swap
-
-                size_t old_queue_idx = nm->queue;
-                queues_vec[old_queue_idx].erase(nmi);
-                size_t new_queue_idx = old_queue_idx + 1;
-
-                // check to update the memoized lowest queue
-                if (queues_vec[lowest_active_queue].empty())
-                    lowest_active_queue += 1;
-
-                // check if we've maxed out the queues
-                if (new_queue_idx == queues_vec.size()) {
-                    // break out of the loop and exit after this
-                    cont = false;
-                }
-                else {
-                    queues_vec[new_queue_idx].emplace_back(nm);
-                    nm->queue = new_queue_idx;
-                    // subtract off the bucket interval to indicate promotion
-                    nm->interval_bfs -= bucket_interval;
-                    //printf("q0l: %zu; promotion to %zu; ibfs: %zu\n",
-                    //        queues_vec[0].size(), fm->queue, fm->interval_bfs);
-
-                    // NOTE: we only do the swap to a lower bucket
-                    // (never to same)
-                    if (lowest_active_queue < nm->queue) {
-
-                        // pop-and-push in the lowest active queue
-                        auto lnm = queues_vec[lowest_active_queue].front();
-                        queues_vec[lowest_active_queue].pop_front();
-                        queues_vec[lowest_active_queue].emplace_back(lnm);
-
-                        // swap job_idx in l/fm and page_map
-                        nm->job_idx = lnm->job_idx;
-                        lnm->job_idx = j.idx;
-
-                        // update job_map to reflect the now-swapped mapping.
-                        // both frames are now at the back of their respective
-                        // queues.
-                        auto new_queue_back =
-                                std::next(queues_vec[new_queue_idx].end(), -1);
-                        auto lowest_queue_back =
-                                std::next(queues_vec[lowest_active_queue].end(),
-                                -1);
-
-                        job_map[nm->job_idx] = new_queue_back;
-                        job_map[lnm->job_idx] = lowest_queue_back;
-
-                        // apply the swap write itself to both nodes
-                        // NOTE: technically, our "bit flip percentages" are
-                        // defined only for successive time steps of writes of
-                        // the same job onto a node, and undefined for
-                        // "job 1" being remapped onto a node originally mapped
-                        // by "job 0". However, we can approximate the remap
-                        // bitflip as the *newly-mapped* job's bitflip value.
-                        uint64_t lnm_rss_bytes = jobs[lnm->job_idx].rss_bytes;
-                        uint64_t nm_rss_bytes = jobs[nm->job_idx].rss_bytes;
-                        // note the switchover
-                        uint64_t nm_swap_bfs = lnm_rss_bytes *
-                                jobs[lnm->job_idx].write_factor;
-                        uint64_t lnm_swap_bfs = nm_rss_bytes *
-                                jobs[nm->job_idx].write_factor;
-                        nm->interval_bfs += nm_swap_bfs;
-                        nm->lifetime_bfs += nm_swap_bfs;
-                        lnm->interval_bfs += lnm_swap_bfs;
-                        lnm->lifetime_bfs += lnm_swap_bfs;
-
-                        // increment the total bytes transferred, as well as
-                        // as well as "total_bytes_delay", which counts the
-                        // maximum of the two amounts transferred. this allows
-                        // us to calculate a transfer delay (since the link is
-                        // assumed to be full-duplex)
-                        total_bytes_transferred += lnm_rss_bytes + nm_rss_bytes;
-                        total_bytes_delay +=
-                                std::max(lnm_rss_bytes, nm_rss_bytes);
-
-                        ++total_n_promotions;
-                    }
-                }
+        cont = run_epoch();
+    }
+}
+
+
+/*
+ * Run one epoch (scheduler quantum) over every job, and advance to the next.
+ * Returns false iff the memory has reached end of life.
+ * NOTE: the system time is derived from the epoch count (and not accumulated
+ * quantum by quantum), so that skipped epochs (see skip_epochs()) give
+ * exactly the same time.
+ */
+bool
+MNQueues::run_epoch()
+{
+    bool cont = true;
+
+    for (auto& j : jobs) {
+        // find out what node this job is currently mapped to
+        auto nmi = job_map[j.idx];
+        node_meta_t* nm = *nmi;
+
+        if (nm->interval_bfs > bucket_interval) {
+            // node has hit its write interval.
+            // 1. promote the node into the next-higher queue
+            // 2. in the lowest active queue, "rotate" the head node with
+            //    the tail node
+            // 3. swap the contents of the new tail node in the lowest
+            //    queue with the promoted node
+            // NOTE: we do account for extra writes incurred by swap
+
+            size_t old_queue_idx = nm->queue;
+            queues_vec[old_queue_idx].erase(nmi);
+            size_t new_queue_idx = old_queue_idx + 1;
+            if (event_driven) promoted_nodes.emplace_back(nm);
+
+            // check to update the memoized lowest queue
+            if (queues_vec[lowest_active_queue].empty())
+                lowest_active_queue += 1;
+
+            // check if we've maxed out the queues
+            if (new_queue_idx == queues_vec.size()) {
+                // break out of the loop and exit after this
+                cont = false;
             }
             else {
-                nm->interval_bfs += jobs[nm->job_idx].bit_writes_per_quanta;
+                queues_vec[new_queue_idx].emplace_back(nm);
+                nm->queue = new_queue_idx;
+                // (nmi was erased; if there's no swap below, this is where
+                // the job's node now is)
+                job_map[j.idx] = std::next(queues_vec[new_queue_idx].end(),
+                        -1);
+                // subtract off the bucket interval to indicate promotion
+                nm->interval_bfs -= bucket_interval;
+                //printf("q0l: %zu; promotion to %zu; ibfs: %zu\n",
+                //        queues_vec[0].size(), fm->queue, fm->interval_bfs);
+
+                // NOTE: we only do the swap to a lower bucket
+                // (never to same)
+                if (lowest_active_queue < nm->queue) {
+
+                    // pop-and-push in the lowest active queue
+                    auto lnm = queues_vec[lowest_active_queue].front();
+                    queues_vec[lowest_active_queue].pop_front();
+                    queues_vec[lowest_active_queue].emplace_back(lnm);
+                    if (event_driven) promoted_nodes.emplace_back(lnm);
+
+                    // swap job_idx in l/fm and page_map
+                    nm->job_idx = lnm->job_idx;
+                    lnm->job_idx = j.idx;
+
+                    // update job_map to reflect the now-swapped mapping.
+                    // both frames are now at the back of their respective
+                    // queues.
+                    auto new_queue_back =
+                            std::next(queues_vec[new_queue_idx].end(), -1);
+                    auto lowest_queue_back =
+                            std::next(queues_vec[lowest_active_queue].end(),
+                            -1);
+
+                    job_map[nm->job_idx] = new_queue_back;
+                    job_map[lnm->job_idx] = lowest_queue_back;
+
+                    // apply the swap write itself to both nodes
+                    // NOTE: technically, our "bit flip percentages" are
+                    // defined only for successive time steps of writes of
+                    // the same job onto a node, and undefined for
+                    // "job 1" being remapped onto a node originally mapped
+                    // by "job 0". However, we can approximate the remap
+                    // bitflip as the *newly-mapped* job's bitflip value.
+                    uint64_t lnm_rss_bytes = jobs[lnm->job_idx].rss_bytes;
+                    uint64_t nm_rss_bytes = jobs[nm->job_idx].rss_bytes;
+                    // note the switchover
+                    uint64_t nm_swap_bfs = lnm_rss_bytes *
+                            jobs[lnm->job_idx].write_factor;
+                    uint64_t lnm_swap_bfs = nm_rss_bytes *
+                            jobs[nm->job_idx].write_factor;
+                    nm->interval_bfs += nm_swap_bfs;
+                    nm->lifetime_bfs += nm_swap_bfs;
+                    lnm->interval_bfs += lnm_swap_bfs;
+                    lnm->lifetime_bfs += lnm_swap_bfs;
+
+                    // increment the total bytes transferred, as well as
+                    // as well as "total_bytes_delay", which counts the
+                    // maximum of the two amounts transferred. this allows
+                    // us to calculate a transfer delay (since the link is
+                    // assumed to be full-duplex)
+                    total_bytes_transferred += lnm_rss_bytes + nm_rss_bytes;
+                    total_bytes_delay +=
+                            std::max(lnm_rss_bytes, nm_rss_bytes);
+
+                    ++total_n_promotions;
+                }
             }
+        }
+        else {
+            nm->interval_bfs += jobs[nm->job_idx].bit_writes_per_quanta;
+        }
 
 
-            //// whether we hit interval or not, increment both bfs
-            nm->lifetime_bfs += jobs[nm->job_idx].bit_writes_per_quanta;
+        //// whether we hit interval or not, increment both bfs
+        nm->lifetime_bfs += jobs[nm->job_idx].bit_writes_per_quanta;
 
 
-            // always check to update the most-written node at end
-            // nullptr check: ensure we always have some valid most_written_node
-            if (most_written_node == nullptr or
-                    nm->lifetime_bfs > most_written_node->lifetime_bfs) {
-                most_written_node = nm;
-            }
+        // always check to update the most-written node at end
+        // nullptr check: ensure we always have some valid most_written_node
+        if (most_written_node == nullptr or
+                nm->lifetime_bfs > most_written_node->lifetime_bfs) {
+            most_written_node = nm;
         }
+    }
 
-        system_time_s += scheduler_quanta_s;
+    ++epoch;
+    system_time_s = scheduler_quanta_s * epoch;
 
-        // if we're within n_promotions_to_event_trace, trace the event
-        // timestamp (system time in s)
-        if (total_n_promotions < n_promotions_to_event_trace) {
-            double curr_timestamp = system_time_s;
-            event_trace.get()->write((char*) &curr_timestamp,
-                    sizeof(curr_timestamp));
+    // if we're within n_promotions_to_event_trace, trace the event
+    // timestamp (system time in s)
+    if (total_n_promotions < n_promotions_to_event_trace) {
+        double curr_timestamp = system_time_s;
+        event_trace.get()->write((char*) &curr_timestamp,
+                sizeof(curr_timestamp));
+    }
+
+    return cont;
+}
+
+
+/*
+ * The epoch-by-epoch loop, but skipping over the epochs without promotions:
+ * each node's next promotion epoch is kept in a min-heap, and the epochs
+ * before the earliest are applied in closed form (see skip_epochs()). Epochs
+ * with a promotion (or a stats print) are run as usual. The results are
+ * exactly those of the epoch-by-epoch loop, in time proportional to the n.
+ * epochs with promotions (times the n. nodes), rather than to the n. epochs.
+ */
+void
+MNQueues::run_event_driven()
+{
+    typedef std::pair<uint64_t, node_meta_t*> event_t;
+    // (stale entries, of nodes since rescheduled, are skipped when popped)
+    std::priority_queue<event_t, std::vector<event_t>, std::greater<event_t>>
+            events;
+    auto schedule = [&](node_meta_t* nm) {
+        nm->promotion_epoch = get_promotion_epoch(nm);
+        if (nm->promotion_epoch != NO_EPOCH)
+            events.emplace(nm->promotion_epoch, nm);
+    };
+
+    for (auto& nmi : job_map) schedule(*nmi);
+
+    bool cont = true;
+    while (epoch < n_iterations and cont) {
+        while (!events.empty() and events.top().first !=
+                events.top().second->promotion_epoch)
+            events.pop();
+
+        // (the next epoch at which the epoch-by-epoch loop prints stats)
+        uint64_t stats_epoch = epoch + (N_EPOCHS_PER_STATS_DUMP - 1) -
+                (epoch % N_EPOCHS_PER_STATS_DUMP);
+        uint64_t next_epoch = std::min({events.empty() ? NO_EPOCH :
+                events.top().first, stats_epoch, n_iterations});
+        skip_epochs(next_epoch - epoch);
+        if (epoch == n_iterations) break;
+
+        if (epoch == stats_epoch)
+            dump_stats(false /* incremental, not final */);
+
+        promoted_nodes.clear();
+        cont = run_epoch();
+        for (auto nm : promoted_nodes) schedule(nm);
+    }
+}
+
+
+/*
+ * At the start of the current epoch: the epoch at which nm's promotion check
+ * will first fire, if it only takes its current job's writes until then.
+ */
+uint64_t
+MNQueues::get_promotion_epoch(const node_meta_t* nm)
+{
+    if (nm->interval_bfs > bucket_interval) return epoch;
+
+    uint64_t bwpq = jobs[nm->job_idx].bit_writes_per_quanta;
+    if (bwpq == 0) return NO_EPOCH;
+    return epoch + (bucket_interval - nm->interval_bfs) / bwpq + 1;
+}
+
+
+/*
+ * Apply n_epochs epochs without promotions in aggregate: every node takes
+ * n_epochs of its job's writes. The most-written node is then the one the
+ * epoch-by-epoch loop would have ended up with: as every node is checked
+ * once per epoch, in job order, that's the first in job order at the last
+ * epoch's maximum wear, unless the maximum stopped growing before then
+ * (i.e., only idle jobs' nodes are at it), in which case it's whichever held
+ * it since.
+ */
+void
+MNQueues::skip_epochs(uint64_t n_epochs)
+{
+    if (n_epochs == 0) return;
+
+    // the maximum wear after the first, second to last and last epochs
+    uint64_t max_bfs_first = 0;
+    uint64_t max_bfs_prev = 0;
+    uint64_t max_bfs = 0;
+    for (auto& nmi : job_map) {
+        node_meta_t* nm = *nmi;
+        uint64_t bwpq = jobs[nm->job_idx].bit_writes_per_quanta;
+        max_bfs_first = std::max(max_bfs_first, nm->lifetime_bfs + bwpq);
+        max_bfs_prev = std::max(max_bfs_prev, nm->lifetime_bfs +
+                (n_epochs - 1) * bwpq);
+        max_bfs = std::max(max_bfs, nm->lifetime_bfs + n_epochs * bwpq);
+    }
+
+    // which epoch's check last changed the most-written node, if any; past
+    // the first, it can only change while the maximum grows, and once that
+    // starts, it grows every epoch
+    uint64_t decisive_epoch = n_epochs;
+    uint64_t decisive_max_bfs = max_bfs;
+    if (n_epochs > 1 and max_bfs == max_bfs_prev) {
+        decisive_epoch = 1;
+        decisive_max_bfs = max_bfs_first;
+    }
+    if (decisive_epoch == 1 and most_written_node != nullptr and
+            most_written_node->lifetime_bfs == decisive_max_bfs)
+        decisive_epoch = 0;
+
+    bool found = decisive_epoch == 0;
+    for (auto& nmi : job_map) {
+        node_meta_t* nm = *nmi;
+        uint64_t bwpq = jobs[nm->job_idx].bit_writes_per_quanta;
+        if (!found and nm->lifetime_bfs + decisive_epoch * bwpq ==
+                decisive_max_bfs) {
+            most_written_node = nm;
+            found = true;
         }
+
+        nm->interval_bfs += n_epochs * bwpq;
+        nm->lifetime_bfs += n_epochs * bwpq;
     }
+
+    // (no promotions, so the event trace either takes every epoch or none)
+    for (uint64_t e = epoch + 1; e <= epoch + n_epochs and
+            total_n_promotions < n_promotions_to_event_trace; ++e) {
+        double curr_timestamp = scheduler_quanta_s * e;
+        event_trace.get()->write((char*) &curr_timestamp,
+                sizeof(curr_timestamp));
+    }
+
+    epoch += n_epochs;
+    system_time_s = scheduler_quanta_s * epoch;
 }
 
 
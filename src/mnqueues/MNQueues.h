@@ -3,6 +3,9 @@
  * 1. directory containing bittrack.{txt, bin}, and
  * 2. directory containing memtrace.bin,
  * and gives progressive lifetime estimates of how long the system will last.
+ * Between promotions, every node's wear grows by a fixed amount per epoch, so
+ * (by default) the rebalancing simulation jumps straight from one epoch with
+ * a promotion to the next, applying the epochs in between in closed form.
  */
 #pragma once
 
@@ -52,6 +55,9 @@ class MNQueues {
             uint64_t queue;
             // (figurative) backpointer to the job currently mapped to us
             job_id_t job_idx;
+            // (event-driven only) the epoch of our next promotion, or
+            // NO_EPOCH if never, at our current job's rate
+            uint64_t promotion_epoch;
         } node_meta_t;
 
 
@@ -60,6 +66,14 @@ class MNQueues {
                 parse_jobs_str(const std::string& jobs_str);
         void run_rebalance();
         void run_no_rebalance();
+        bool run_epoch();
+        void run_event_driven();
+        void skip_epochs(uint64_t n_epochs);
+        uint64_t get_promotion_epoch(const node_meta_t* nm);
+
+        static constexpr uint64_t N_EPOCHS_PER_STATS_DUMP = 100000000;
+        static constexpr uint64_t NO_EPOCH =
+                std::numeric_limits<uint64_t>::max();
 
 
         // input arguments
@@ -72,6 +86,7 @@ class MNQueues {
         uint64_t n_bytes_mem_per_node;
         double scheduler_quanta_s;
         int rebalance;
+        int event_driven;
         std::string jobs_str;
 
         // derived, or from input files
@@ -96,6 +111,9 @@ class MNQueues {
         uint64_t total_bytes_delay = 0;
         double system_time_s = 0.0;
         std::unique_ptr<std::ofstream> event_trace;
+        // (event-driven only) the nodes whose wear changed other than by
+        // their job's fixed rate in the current epoch (i.e., by promotion)
+        std::vector<node_meta_t*> promoted_nodes;
 
         // memoize some things to keep some operations O(1)
         node_meta_t* most_written_node = nullptr;
@@ -13,8 +13,8 @@
  */
 Cache::Cache(uint64_t n_lines, uint64_t n_banks, uint64_t n_ways,
         allocation_policy_t allocation_policy,
-        eviction_policy_t eviction_policy) : n_lines(n_lines), n_banks(n_banks),
-        n_ways(n_ways), allocation_policy(allocation_policy),
+        eviction_policy_t eviction_policy, bool track_dirty) : n_lines(n_lines),
+        n_banks(n_banks), n_ways(n_ways), allocation_policy(allocation_policy),
         eviction_policy(eviction_policy)
 
 {
@@ -26,7 +26,7 @@ Cache::Cache(uint64_t n_lines, uint64_t n_banks, uint64_t n_ways,
         size_t bank_gid = i;
         // still invokes move constructor
         banks.emplace_back(bank_gid, n_sets_per_bank, n_ways, allocation_policy,
-                eviction_policy);
+                eviction_policy, track_dirty);
     }
 }
 
@@ -61,6 +61,21 @@ Cache::access(line_addr_t line_addr, mem_ref_type_t type)
 }
 
 
+/*
+ * Write back every dirty line, appending them to line_addrs in ascending
+ * order; they stay resident, now clean.
+ */
+void
+Cache::write_back(std::vector<line_addr_t>& line_addrs)
+{
+    size_t n_line_addrs = line_addrs.size();
+    for (auto& b : banks) {
+        b.write_back(line_addrs);
+    }
+    std::sort(line_addrs.begin() + n_line_addrs, line_addrs.end());
+}
+
+
 void
 Cache::aggregate_stats()
 {
@@ -72,6 +87,7 @@ Cache::aggregate_stats()
             n_rd_misses += s.n_rd_misses;
             n_wr_misses += s.n_wr_misses;
             n_evictions += s.n_evictions;
+            n_dirty_evictions += s.n_dirty_evictions;
         }
     }
 }
@@ -91,6 +107,7 @@ Cache::clear_stats()
             s.n_rd_misses = 0;
             s.n_wr_misses = 0;
             s.n_evictions = 0;
+            s.n_dirty_evictions = 0;
         }
     }
 
@@ -100,4 +117,5 @@ Cache::clear_stats()
     n_rd_misses = 0;
     n_wr_misses = 0;
     n_evictions = 0;
+    n_dirty_evictions = 0;
 }
@@ -18,7 +18,7 @@ class Cache {
     public:
         Cache(uint64_t n_lines, uint64_t n_banks, uint64_t n_ways,
                 allocation_policy_t allocation_policy,
-                eviction_policy_t eviction_policy);
+                eviction_policy_t eviction_policy, bool track_dirty = false);
         Cache(const Cache& c) = delete;
         Cache& operator=(const Cache& c) = delete;
         Cache(Cache&& c) = delete;
@@ -28,6 +28,7 @@ class Cache {
         access_result_t access(line_addr_t addr, mem_ref_type_t type,
                 line_addr_t& evicted_line_addr);
         access_result_t access(line_addr_t line_addr, mem_ref_type_t type);
+        void write_back(std::vector<line_addr_t>& line_addrs);
 
         void aggregate_stats();
         void clear_stats();
@@ -36,6 +37,7 @@ class Cache {
         uint64_t get_n_rd_misses();
         uint64_t get_n_wr_misses();
         uint64_t get_n_evictions();
+        uint64_t get_n_dirty_evictions();
 
     private:
         uint32_t fast_hash(uint64_t in, uint64_t modulo);
@@ -55,6 +57,7 @@ class Cache {
         uint64_t n_rd_misses = 0;
         uint64_t n_wr_misses = 0;
         uint64_t n_evictions = 0;
+        uint64_t n_dirty_evictions = 0;
 
         friend class Bank;
         friend class Set;
@@ -110,3 +113,10 @@ Cache::get_n_evictions()
 {
     return this->n_evictions;
 }
+
+
+inline uint64_t
+Cache::get_n_dirty_evictions()
+{
+    return this->n_dirty_evictions;
+}
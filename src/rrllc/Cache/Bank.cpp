@@ -3,13 +3,14 @@
 
 Bank::Bank(size_t gid, size_t n_sets, size_t n_ways,
         allocation_policy_t allocation_policy,
-        eviction_policy_t eviction_policy) : gid(gid), n_sets(n_sets),
-        n_ways(n_ways)
+        eviction_policy_t eviction_policy, bool track_dirty) : gid(gid),
+        n_sets(n_sets), n_ways(n_ways)
 {
     for (size_t i = 0; i < n_sets; ++i) {
         size_t set_gid = gid * n_sets + i;
         // still invokes move constructor
-        sets.emplace_back(set_gid, n_ways, allocation_policy, eviction_policy);
+        sets.emplace_back(set_gid, n_ways, allocation_policy, eviction_policy,
+                track_dirty);
     }
 }
 
@@ -23,3 +24,12 @@ Bank::access(line_addr_t line_addr, mem_ref_type_t type,
 
     return sets[set_idx].access(line_addr, type, evicted_line_addr);
 }
+
+
+void
+Bank::write_back(std::vector<line_addr_t>& line_addrs)
+{
+    for (auto& s : sets) {
+        s.write_back(line_addrs);
+    }
+}
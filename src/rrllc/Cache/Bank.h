@@ -18,10 +18,11 @@ class Bank {
     public:
         Bank(size_t gid, size_t n_sets, size_t n_ways,
                 allocation_policy_t allocation_policy,
-                eviction_policy_t eviction_policy);
+                eviction_policy_t eviction_policy, bool track_dirty = false);
 
         access_result_t access(line_addr_t line_addr, mem_ref_type_t type,
                 line_addr_t& evicted_line_addr);
+        void write_back(std::vector<line_addr_t>& line_addrs);
 
         // Buffer iterates over these in aggregate_stats()
         std::vector<Set> sets;
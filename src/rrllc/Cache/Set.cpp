@@ -11,8 +11,9 @@
 
 
 Set::Set(size_t gid, size_t n_ways, allocation_policy_t allocation_policy,
-        eviction_policy_t eviction_policy) : gid(gid), n_ways(n_ways),
-        allocation_policy(allocation_policy), eviction_policy(eviction_policy),
+        eviction_policy_t eviction_policy, bool track_dirty) : gid(gid),
+        n_ways(n_ways), allocation_policy(allocation_policy),
+        eviction_policy(eviction_policy), track_dirty(track_dirty),
         rand_gen(gid), rand_dist(0, n_ways - 1)
 {
     if (eviction_policy == EVICTION_POLICY_LRU) {
@@ -55,6 +56,8 @@ Set::access(line_addr_t line_addr, mem_ref_type_t type,
             auto new_it = lru_list.emplace(lru_list.end(), line_addr);
             lru_map[line_addr] = new_it;
 
+            if (track_dirty and type == MEM_REF_TYPE_ST)
+                dirty_line_addrs.emplace(line_addr);
             return ACCESS_RESULT_HIT | ACCESS_RESULT_NO_EVICTION;
         }
         else {
@@ -82,7 +85,8 @@ Set::access(line_addr_t line_addr, mem_ref_type_t type,
 
                     ++n_evictions;
                     evicted_line_addr = to_evict_line_addr;
-                    return ACCESS_RESULT_MISS | ACCESS_RESULT_EVICTION;
+                    return ACCESS_RESULT_MISS | ACCESS_RESULT_EVICTION |
+                            update_dirty(line_addr, type, to_evict_line_addr);
                 }
                 else {
                     // don't need to evict
@@ -91,9 +95,12 @@ Set::access(line_addr_t line_addr, mem_ref_type_t type,
                     lru_map[line_addr] = new_it;
 
                     ++n_ways_active;
+                    if (track_dirty and type == MEM_REF_TYPE_ST)
+                        dirty_line_addrs.emplace(line_addr);
                     return ACCESS_RESULT_MISS | ACCESS_RESULT_NO_EVICTION;
                 }
             }
+            return ACCESS_RESULT_MISS | ACCESS_RESULT_NO_EVICTION;
         }
     }
 
@@ -104,6 +111,8 @@ Set::access(line_addr_t line_addr, mem_ref_type_t type,
         if (it != rand_set.end()) {
             // it was a hit
             (type == MEM_REF_TYPE_LD) ? ++n_rd_hits : ++n_wr_hits;
+            if (track_dirty and type == MEM_REF_TYPE_ST)
+                dirty_line_addrs.emplace(line_addr);
             return ACCESS_RESULT_HIT | ACCESS_RESULT_NO_EVICTION;
         }
         else {
@@ -127,7 +136,8 @@ Set::access(line_addr_t line_addr, mem_ref_type_t type,
 
                     ++n_evictions;
                     evicted_line_addr = to_evict;
-                    return ACCESS_RESULT_MISS | ACCESS_RESULT_EVICTION;
+                    return ACCESS_RESULT_MISS | ACCESS_RESULT_EVICTION |
+                            update_dirty(line_addr, type, to_evict);
                 }
                 else {
                     // append to the vector
@@ -135,12 +145,28 @@ Set::access(line_addr_t line_addr, mem_ref_type_t type,
                     rand_set.emplace(line_addr);
 
                     ++n_ways_active;
+                    if (track_dirty and type == MEM_REF_TYPE_ST)
+                        dirty_line_addrs.emplace(line_addr);
                     return ACCESS_RESULT_MISS | ACCESS_RESULT_NO_EVICTION;
                 }
             }
+            return ACCESS_RESULT_MISS | ACCESS_RESULT_NO_EVICTION;
         }
     }
 
     // should never get here
     return ACCESS_RESULT_INVALID;
 }
+
+
+/*
+ * Hand over the set's dirty lines (appending them to line_addrs) as if
+ * written back; they stay resident, now clean.
+ */
+void
+Set::write_back(std::vector<line_addr_t>& line_addrs)
+{
+    line_addrs.insert(line_addrs.end(), dirty_line_addrs.begin(),
+            dirty_line_addrs.end());
+    dirty_line_addrs.clear();
+}
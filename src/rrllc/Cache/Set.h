@@ -20,10 +20,11 @@
 class Set {
     public:
         Set(size_t gid, size_t n_ways, allocation_policy_t allocation_policy,
-                eviction_policy_t eviction_policy);
+                eviction_policy_t eviction_policy, bool track_dirty = false);
 
         access_result_t access(line_addr_t line_addr, mem_ref_type_t type,
                 line_addr_t& evicted_line_addr);
+        void write_back(std::vector<line_addr_t>& line_addrs);
 
         // statistics
         uint64_t n_rd_hits = 0;
@@ -31,12 +32,17 @@ class Set {
         uint64_t n_rd_misses = 0;
         uint64_t n_wr_misses = 0;
         uint64_t n_evictions = 0;
+        uint64_t n_dirty_evictions = 0;
 
     private:
+        inline access_result_t update_dirty(line_addr_t line_addr,
+                mem_ref_type_t type, line_addr_t evicted_line_addr);
+
         size_t gid;
         size_t n_ways;
         allocation_policy_t allocation_policy;
         eviction_policy_t eviction_policy;
+        bool track_dirty;
 
         // mechanics
         std::list<line_addr_t> lru_list;
@@ -48,5 +54,32 @@ class Set {
         std::mt19937 rand_gen;
         std::uniform_int_distribution<size_t> rand_dist;
 
+        // resident lines written since they were allocated (or written back);
+        // only kept if track_dirty
+        std::unordered_set<line_addr_t> dirty_line_addrs;
+
         size_t n_ways_active = 0;
 };
+
+
+/*
+ * Inline function definitions.
+ */
+/*
+ * On allocating line_addr in place of evicted_line_addr: returns
+ * ACCESS_RESULT_DIRTY_EVICTION iff the evicted line was dirty (never, unless
+ * track_dirty).
+ */
+inline access_result_t
+Set::update_dirty(line_addr_t line_addr, mem_ref_type_t type,
+        line_addr_t evicted_line_addr)
+{
+    if (!track_dirty) return ACCESS_RESULT_NO_EVICTION;
+
+    bool was_dirty = dirty_line_addrs.erase(evicted_line_addr) != 0;
+    if (type == MEM_REF_TYPE_ST) dirty_line_addrs.emplace(line_addr);
+
+    if (!was_dirty) return ACCESS_RESULT_NO_EVICTION;
+    ++n_dirty_evictions;
+    return ACCESS_RESULT_DIRTY_EVICTION;
+}
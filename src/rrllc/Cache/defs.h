@@ -31,11 +31,13 @@ typedef enum {
 
 /*
  * Bitmask. Bit 0 is hit (1) or miss (0); bit 1 is eviction occurred (1) or
- * no eviction occurred (0).
+ * no eviction occurred (0); bit 2 is the evicted line was dirty (1) or clean
+ * (0).
  */
 typedef uint8_t access_result_t;
 static constexpr access_result_t ACCESS_RESULT_HIT = 0b01;
 static constexpr access_result_t ACCESS_RESULT_MISS = 0b00;
 static constexpr access_result_t ACCESS_RESULT_EVICTION = 0b10;
 static constexpr access_result_t ACCESS_RESULT_NO_EVICTION = 0b00;
+static constexpr access_result_t ACCESS_RESULT_DIRTY_EVICTION = 0b100;
 static constexpr access_result_t ACCESS_RESULT_INVALID = 0b11111111;
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include "BucketQueues.h"
+
+
+BucketQueues::BucketQueues(const write_stream_t& ws, const sim_config_t& cfg,
+        uint64_t n_pages_mem) : ws(ws), n_buckets(cfg.n_buckets),
+        queues(cfg.n_buckets)
+{
+    // set some derived variables
+    bits_per_page = cfg.page_size * 8;
+    bucket_cap = bits_per_page * cfg.cell_write_endurance;
+    bucket_interval = get_bucket_interval(cfg);
+    top_queue_end_of_life = cfg.endurance_dist == ENDURANCE_DIST_FIXED;
+
+    // construct all frames in the initial starting queues state: every page
+    // in the trace, in first-touch (i.e., ID) order, in the bottommost queue
+    page_frames.resize(ws.n_pages + 1);
+    for (page_id_t p = 0; p < ws.n_pages; ++p) {
+        frame_idx_t f = queues.alloc_frame(p);
+        queues.push_back(0, f);
+        page_frames[p] = f;
+    }
+    page_frames[ws.filler_page] = NO_FRAME;
+
+    // now, prepend the remainder free frames (up to n_pages_mem) to queue 0.
+    // they're all identical until the lowest-queue rotation first reaches
+    // them, so they're kept as a count, and only materialized then.
+    // NOTE: this means multiple frames will represent the filler page, but
+    // this is fine, as it's just a filler value.
+    size_t n_rem_pages = n_pages_mem - ws.n_pages;
+    queues.add_untouched(0, n_rem_pages, ws.filler_page);
+}
+
+
+BucketQueues::~BucketQueues()
+{
+}
+
+
+uint64_t
+BucketQueues::get_bucket_interval(const sim_config_t& cfg)
+{
+    return cfg.page_size * 8 * cfg.cell_write_endurance / cfg.n_buckets;
+}
+
+
+uint64_t
+BucketQueues::get_param(const sim_config_t& cfg)
+{
+    return cfg.n_buckets;
+}
+
+
+/*
+ * NOTE: a frame promoted out of the highest bucket (i.e., at end of life) is
+ * no longer in any queue, and so isn't counted.
+ */
+uint64_t
+BucketQueues::get_total_bfs()
+{
+    uint64_t bfs = 0;
+
+    for (size_t q = 0; q < queues.get_n_queues(); ++q) {
+        for (frame_idx_t f = queues.front(q); f != NO_FRAME;
+                f = queues[f].next) {
+            bfs += queues[f].lifetime_bfs;
+        }
+    }
+
+    return bfs;
+}
+
+
+/*
+ * The materialized frames, by arena index, then the untouched ones (all zero).
+ * NOTE: unlike get_total_bfs(), this includes a frame promoted out of the
+ * highest bucket.
+ */
+void
+BucketQueues::get_frame_wear(std::vector<uint64_t>& bfs)
+{
+    uint64_t n_untouched = 0;
+    for (size_t q = 0; q < queues.get_n_queues(); ++q)
+        n_untouched += queues.get_n_untouched(q);
+
+    bfs.resize(queues.get_n_frames() + n_untouched);
+    for (frame_idx_t f = 0; f < queues.get_n_frames(); ++f)
+        bfs[f] = queues[f].lifetime_bfs;
+    std::fill(bfs.begin() + queues.get_n_frames(), bfs.end(), 0);
+}
+
+
+void
+BucketQueues::get_queue_sizes(std::vector<uint64_t>& queue_sizes)
+{
+    queue_sizes.resize(queues.get_n_queues());
+    for (size_t q = 0; q < queues.get_n_queues(); ++q)
+        queue_sizes[q] = queues.size(q);
+}
+
+
+/*
+ * At a pass boundary, skip ahead over as many whole passes (up to
+ * max_n_passes) as are guaranteed to contain no promotions, applying their
+ * writes in aggregate. Returns the n. passes skipped (0 if none), which the
+ * caller must then account for, finishing the last as if it had replayed it.
+ *
+ * Without promotions there are no swaps, so over one pass each frame simply
+ * receives its page's writes: w_p writes of b_p bfs each (W_p = w_p * b_p in
+ * total). The frame's write at interval_bfs I promotes iff I >= B (the bucket
+ * interval), so k whole passes are promotion-free iff, for every page written,
+ *     I + (k - 1) * W_p + (w_p - 1) * b_p < B.
+ * The result is exact, including the choice of most-written frame; only the
+ * incremental stats prints of the skipped passes (all but the last) are lost.
+ * NOTE: requires ws.page_n_writes and ws.page_{first,last}_write_idxs.
+ */
+uint64_t
+BucketQueues::fast_forward(uint64_t max_n_passes,
+        frame_idx_t& most_written_frame)
+{
+    // first, find the number of promotion-free passes, k, by the above...
+    uint64_t k = max_n_passes;
+    for (page_id_t p = 0; p < ws.n_pages and k != 0; ++p) {
+        uint64_t w_p = ws.page_n_writes[p];
+        if (w_p == 0) continue;
+
+        uint64_t b_p = ws.page_bfpws[p];
+        uint64_t i_last = queues[page_frames[p]].interval_bfs + (w_p - 1) * b_p;
+        if (i_last >= bucket_interval) k = 0;
+        else if (b_p != 0)
+            k = std::min(k, (bucket_interval - 1 - i_last) / (w_p * b_p) + 1);
+    }
+
+    // (a single pass is no faster to skip than to replay)
+    if (k < 2) return 0;
+
+
+    // ...then apply them. the most-written frame is whichever was
+    // most-written going into the last pass, unless some frame then strictly
+    // exceeds it; frames reach their final bfs at their last write in the
+    // pass (first write, if b_p == 0), and the earliest to reach the max wins
+    uint64_t max_bfs_before_last_pass = queues[most_written_frame].lifetime_bfs;
+    uint64_t max_bfs = 0;
+    uint64_t max_bfs_write_idx = 0;
+    frame_idx_t max_bfs_frame = NO_FRAME;
+
+    for (page_id_t p = 0; p < ws.n_pages; ++p) {
+        uint64_t w_p = ws.page_n_writes[p];
+        if (w_p == 0) continue;
+
+        uint64_t W_p = w_p * ws.page_bfpws[p];
+        frame_idx_t f = page_frames[p];
+        auto& fm = queues[f];
+        fm.interval_bfs += k * W_p;
+        fm.lifetime_bfs += k * W_p;
+
+        max_bfs_before_last_pass = std::max(max_bfs_before_last_pass,
+                fm.lifetime_bfs - W_p);
+
+        uint64_t write_idx = W_p == 0 ? ws.page_first_write_idxs[p] :
+                ws.page_last_write_idxs[p];
+        if (fm.lifetime_bfs > max_bfs or (fm.lifetime_bfs == max_bfs and
+                write_idx < max_bfs_write_idx)) {
+            max_bfs = fm.lifetime_bfs;
+            max_bfs_write_idx = write_idx;
+            max_bfs_frame = f;
+        }
+    }
+
+    if (max_bfs > max_bfs_before_last_pass) most_written_frame = max_bfs_frame;
+
+    return k;
+}
+
+
+void
+BucketQueues::print_config()
+{
+    printf("n. buckets: %zu\n", n_buckets);
+    printf("bucket interval: %zu\n", bucket_interval);
+    printf("bucket cap: %zu\n", bucket_cap);
+}
+
+
+void
+BucketQueues::dump_config(std::stringstream& ss)
+{
+    ss << "QUEUES" << " " << n_buckets << std::endl;
+}
+
+
+void
+BucketQueues::dump_stats(std::stringstream& ss,
+        frame_idx_t most_written_frame)
+{
+    ss << "MOST_WRITTEN_FRAME_QUEUE" << " " <<
+            queues[most_written_frame].queue << std::endl;
+    ss << "LOWEST_ACTIVE_QUEUE" << " " << lowest_active_queue << std::endl;
+}
+
+
+void
+BucketQueues::save(Checkpoint& ckpt)
+{
+    ckpt.put(n_buckets);
+    ckpt.put(total_n_promotions);
+    ckpt.put((uint64_t) lowest_active_queue);
+    ckpt.put_vector(page_frames);
+    queues.save(ckpt);
+}
+
+
+/*
+ * NOTE: the endurance (and so the bucket interval) may differ from the saved
+ * run's; the n. buckets may not.
+ */
+void
+BucketQueues::load(Checkpoint& ckpt)
+{
+    uint64_t ckpt_n_buckets, ckpt_lowest_active_queue;
+    ckpt.get(ckpt_n_buckets);
+    if (ckpt_n_buckets != n_buckets)
+        throw std::runtime_error("checkpoint has a different n. buckets");
+
+    ckpt.get(total_n_promotions);
+    ckpt.get(ckpt_lowest_active_queue);
+    ckpt.get_vector(page_frames);
+    queues.load(ckpt);
+    lowest_active_queue = ckpt_lowest_active_queue;
+
+    if (page_frames.size() != ws.n_pages + 1)
+        throw std::runtime_error("checkpoint is truncated or corrupt");
+}
@@ -0,0 +1,205 @@
+/*
+ * The SNQueues bucketed-queues wear-leveling policy: frames sorted into
+ * buckets (queues) by wear, where a frame that has taken another bucket
+ * interval's worth of bit flips is promoted to the next bucket up, and its
+ * page is swapped with the head of the lowest non-empty bucket. End of life is
+ * when some frame tops the highest bucket.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdbool>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include "Checkpoint.h"
+#include "FrameQueues.h"
+#include "Policy.h"
+#include "WriteStream.h"
+
+
+class BucketQueues {
+    public:
+        BucketQueues(const write_stream_t& ws, const sim_config_t& cfg,
+                uint64_t n_pages_mem);
+        BucketQueues(const BucketQueues& bq) = delete;
+        BucketQueues& operator=(const BucketQueues& bq) = delete;
+        BucketQueues(BucketQueues&& bq) = delete;
+        BucketQueues& operator=(BucketQueues&& bq) = delete;
+        ~BucketQueues();
+
+        inline bool write(page_id_t p, uint64_t page_bfpw, uint64_t n_writes,
+                frame_idx_t& f);
+        inline uint64_t get_lifetime_bfs(frame_idx_t f);
+        uint64_t get_total_bfs();
+        void get_frame_wear(std::vector<uint64_t>& bfs);
+        void get_queue_sizes(std::vector<uint64_t>& queue_sizes);
+        inline uint64_t get_n_remaps();
+        inline const remap_t& get_last_remap();
+        uint64_t fast_forward(uint64_t max_n_passes,
+                frame_idx_t& most_written_frame);
+
+        void print_config();
+        void dump_config(std::stringstream& ss);
+        void dump_stats(std::stringstream& ss, frame_idx_t most_written_frame);
+        void save(Checkpoint& ckpt);
+        void load(Checkpoint& ckpt);
+
+        static uint64_t get_bucket_interval(const sim_config_t& cfg);
+        static uint64_t get_param(const sim_config_t& cfg);
+
+        static constexpr policy_t ID = POLICY_BUCKETS;
+        static constexpr bool CAN_FAST_FORWARD = true;
+        static constexpr const char* PARAM_NAME = "QUEUES";
+        static constexpr const char* N_REMAPS_NAME = "TOTAL_N_PROMOTIONS";
+
+    private:
+        const write_stream_t& ws;
+        uint64_t n_buckets;
+
+        // derived
+        uint64_t bits_per_page;
+        uint64_t bucket_interval;
+        uint64_t bucket_cap;
+        // whether promotion out of the top queue is end of life; with
+        // endurance variation, the frames' own caps judge it instead, and a
+        // frame stays in the top queue
+        bool top_queue_end_of_life;
+
+        // internal mechanics
+        std::vector<frame_idx_t> page_frames;
+        FrameQueues queues;
+        // (counts the promotions that swapped)
+        uint64_t total_n_promotions = 0;
+        remap_t last_remap = {{NO_FRAME, NO_FRAME}, {0, 0}};
+
+        // memoize to keep promotions O(1)
+        size_t lowest_active_queue = 0;
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline bool
+BucketQueues::write(page_id_t p, uint64_t page_bfpw, uint64_t n_writes,
+        frame_idx_t& f)
+{
+    bool alive = true;
+
+    f = page_frames[p];
+    auto* fm = &queues[f];
+    //printf("FM idx = %u; fm q=%u; fm ibf=%zu; fm lbf=%zu\n",
+    //        f, fm->queue, fm->interval_bfs, fm->lifetime_bfs);
+
+    if (fm->interval_bfs >= bucket_interval) {
+        //printf("%u hit interval; q=%u\n", f, fm->queue);
+        // frame has hit its write interval.
+        // 1. promote the frame into the next-higher queue
+        // 2. in the lowest active queue, "rotate" the head frame with
+        //    the tail frame
+        // 3. swap the contents of the new tail frame in the lowest
+        //    queue with the promoted frame (i.e., update page in
+        //    fm and map)
+        // NOTE: we do account for extra writes incurred by swap
+
+        size_t old_queue_idx = fm->queue;
+        queues.erase(f);
+        size_t new_queue_idx = old_queue_idx + 1;
+
+        // check to update the memoized lowest queue
+        if (queues.empty(lowest_active_queue))
+            lowest_active_queue += 1;
+
+        // check if we've maxed out the queues
+        if (new_queue_idx == queues.get_n_queues()) {
+            if (top_queue_end_of_life) {
+                // end of life; stop after this write
+                alive = false;
+            }
+            else {
+                new_queue_idx = old_queue_idx;
+                // (it may have been the last frame of the lowest active
+                // queue)
+                lowest_active_queue = std::min(lowest_active_queue,
+                        new_queue_idx);
+            }
+        }
+        if (alive) {
+            queues.push_back(new_queue_idx, f);
+            // subtract off the bucket interval to indicate promotion
+            fm->interval_bfs -= bucket_interval;
+            //printf("q0l: %zu; promotion to %u; ibfs: %zu\n",
+            //        queues.size(0), fm->queue, fm->interval_bfs);
+
+            // NOTE: we only do the swap to a lower bucket (never to same)
+            if (lowest_active_queue < fm->queue) {
+
+                // pop-and-push in the lowest active queue
+                frame_idx_t lf = queues.pop_front(lowest_active_queue);
+                queues.push_back(lowest_active_queue, lf);
+                // (popping an untouched frame may have moved the arena)
+                fm = &queues[f];
+                auto& lfm = queues[lf];
+
+                // swap pages in l/fm
+                fm->page = lfm.page;
+                lfm.page = p;
+
+                // update page_frames to reflect the now-swapped mapping
+                page_frames[fm->page] = f;
+                page_frames[lfm.page] = lf;
+
+
+                // apply the swap write itself to both frames
+                // 1. look up bfpw for the lower frame
+                uint64_t lfm_bfpw = ws.page_bfpws[lfm.page];
+                // 2. apply to both frames
+                // NOTE: technically, our "bit flip percentages" are defined
+                // only for successive time steps of writes of the same
+                // page onto a frame, and undefined for "page 1" being
+                // remapped onto a frame originally mapped by "page 0".
+                // However, we can approximate the remap bitflip as the
+                // *newly-mapped* page's bitflip value.
+                fm->interval_bfs += lfm_bfpw;
+                fm->lifetime_bfs += lfm_bfpw;
+                lfm.interval_bfs += page_bfpw;
+                lfm.lifetime_bfs += page_bfpw;
+
+                ++total_n_promotions;
+                last_remap = {{f, lf}, {lfm_bfpw, page_bfpw}};
+            }
+        }
+    }
+    else {
+        fm->interval_bfs += page_bfpw;
+    }
+
+
+    //// whether we hit interval or not, increment both bfs
+    fm->lifetime_bfs += page_bfpw;
+
+    return alive;
+}
+
+
+inline uint64_t
+BucketQueues::get_lifetime_bfs(frame_idx_t f)
+{
+    return queues[f].lifetime_bfs;
+}
+
+
+inline uint64_t
+BucketQueues::get_n_remaps()
+{
+    return total_n_promotions;
+}
+
+
+inline const remap_t&
+BucketQueues::get_last_remap()
+{
+    return last_remap;
+}
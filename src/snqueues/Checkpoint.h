@@ -0,0 +1,144 @@
+/*
+ * A flat little-endian byte buffer for SNQueues checkpoints: fixed-size
+ * values and vectors of them are appended in order by put*(), and read back
+ * in the same order by get*(). Reads past the end (i.e., a truncated or
+ * mismatched checkpoint) throw std::runtime_error.
+ * NOTE: there is no corresponding .cpp file; everything is declared inline and
+ * defined in this .h file.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+class Checkpoint {
+    public:
+        Checkpoint() = default;
+        Checkpoint(const Checkpoint& ckpt) = delete;
+        Checkpoint& operator=(const Checkpoint& ckpt) = delete;
+        Checkpoint(Checkpoint&& ckpt) = default;
+        Checkpoint& operator=(Checkpoint&& ckpt) = default;
+        ~Checkpoint() = default;
+
+        template <typename T> inline void put(const T& v);
+        template <typename T> inline void put_vector(const std::vector<T>& v);
+        template <typename T> inline void get(T& v);
+        template <typename T> inline void get_vector(std::vector<T>& v);
+
+        inline void write_file(const std::string& filepath) const;
+        inline void read_file(const std::string& filepath);
+
+        // identifies the format; bump the version on any layout change
+        static constexpr uint64_t MAGIC = 0x31544b4351534e53;  // "SNSQCKT1"
+        static constexpr uint64_t VERSION = 4;
+
+    private:
+        inline void get_bytes(void* dst, size_t n_bytes);
+
+        std::vector<char> bytes;
+        size_t read_pos = 0;
+};
+
+
+/*
+ * Inline function definitions.
+ */
+template <typename T>
+inline void
+Checkpoint::put(const T& v)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "not a flat type");
+    const char* src = (const char*) &v;
+    bytes.insert(bytes.end(), src, src + sizeof(T));
+}
+
+
+template <typename T>
+inline void
+Checkpoint::put_vector(const std::vector<T>& v)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "not a flat type");
+    put((uint64_t) v.size());
+    const char* src = (const char*) v.data();
+    bytes.insert(bytes.end(), src, src + v.size() * sizeof(T));
+}
+
+
+inline void
+Checkpoint::get_bytes(void* dst, size_t n_bytes)
+{
+    if (n_bytes > bytes.size() - read_pos)
+        throw std::runtime_error("checkpoint is truncated or corrupt");
+
+    std::memcpy(dst, bytes.data() + read_pos, n_bytes);
+    read_pos += n_bytes;
+}
+
+
+template <typename T>
+inline void
+Checkpoint::get(T& v)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "not a flat type");
+    get_bytes(&v, sizeof(T));
+}
+
+
+template <typename T>
+inline void
+Checkpoint::get_vector(std::vector<T>& v)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "not a flat type");
+    uint64_t n;
+    get(n);
+    if (n > (bytes.size() - read_pos) / sizeof(T))
+        throw std::runtime_error("checkpoint is truncated or corrupt");
+
+    v.resize(n);
+    get_bytes(v.data(), n * sizeof(T));
+}
+
+
+/*
+ * Write via a temporary file and rename it into place, so that a crash
+ * mid-write leaves the previous checkpoint intact.
+ */
+inline void
+Checkpoint::write_file(const std::string& filepath) const
+{
+    std::string tmp_filepath = filepath + ".tmp";
+    {
+        std::ofstream ofs(tmp_filepath, std::ofstream::out |
+                std::ofstream::binary | std::ofstream::trunc);
+        ofs.write(bytes.data(), bytes.size());
+        ofs.flush();
+        if (!ofs)
+            throw std::runtime_error("could not write checkpoint " +
+                    tmp_filepath);
+    }
+    std::filesystem::rename(tmp_filepath, filepath);
+}
+
+
+inline void
+Checkpoint::read_file(const std::string& filepath)
+{
+    std::ifstream ifs(filepath, std::ios::binary);
+    if (!ifs.is_open())
+        throw std::runtime_error("could not open checkpoint " + filepath);
+
+    ifs.seekg(0, std::ios_base::end);
+    size_t n_bytes = ifs.tellg();
+    ifs.seekg(0, std::ios_base::beg);
+
+    bytes.resize(n_bytes);
+    ifs.read(bytes.data(), n_bytes);
+    read_pos = 0;
+}
@@ -0,0 +1,307 @@
+/*
+ * Frame storage for SNQueues. All frames live in one contiguous arena, and
+ * each bucket queue is an intrusive doubly-linked list threaded through the
+ * frames by arena index, so a frame costs one small struct and no separate
+ * heap allocations, and promotions don't chase list-node pointers.
+ * A queue can also hold a count of untouched (zero-wear, identical) frames
+ * ahead of its linked ones; these take no space until popped, at which point
+ * they're materialized in the arena.
+ * NOTE: there is no corresponding .cpp file; everything is declared inline and
+ * defined in this .h file.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../common/defs.h"
+#include "Checkpoint.h"
+
+
+typedef uint32_t frame_idx_t;
+static constexpr frame_idx_t NO_FRAME = UINT32_MAX;
+// dense ID of a page in the trace (see SNQueues::page_ids)
+typedef uint32_t page_id_t;
+
+
+class FrameQueues {
+    public:
+        typedef struct frame_meta_t {
+            uint64_t interval_bfs;
+            uint64_t lifetime_bfs;
+            // (figurative) backpointer to the page mapped to us
+            page_id_t page;
+            // neighbors within our queue, as arena indices
+            frame_idx_t prev;
+            frame_idx_t next;
+            // (figurative) backpointer to the queue we're in
+            // (store a vector index, and not a raw pointer, so we can get the
+            // "next" queue up after this when promoting)
+            uint32_t queue;
+        } frame_meta_t;
+
+        FrameQueues(size_t n_queues = 0);
+        FrameQueues(const FrameQueues& fq) = delete;
+        FrameQueues& operator=(const FrameQueues& fq) = delete;
+        FrameQueues(FrameQueues&& fq) = default;
+        FrameQueues& operator=(FrameQueues&& fq) = default;
+        ~FrameQueues();
+
+        inline void reserve(size_t n_frames);
+        inline frame_idx_t alloc_frame(page_id_t page);
+        inline void add_untouched(uint32_t queue, uint64_t n_frames,
+                page_id_t page);
+        inline frame_meta_t& operator[](frame_idx_t f);
+        inline size_t get_n_frames();
+        inline size_t get_n_queues();
+
+        inline void push_back(uint32_t queue, frame_idx_t f);
+        inline void push_front(uint32_t queue, frame_idx_t f);
+        inline void erase(frame_idx_t f);
+        inline frame_idx_t pop_front(uint32_t queue);
+        inline frame_idx_t front(uint32_t queue);
+        inline bool empty(uint32_t queue);
+        inline uint64_t size(uint32_t queue);
+        inline uint64_t get_n_untouched(uint32_t queue);
+
+        inline void save(Checkpoint& ckpt);
+        inline void load(Checkpoint& ckpt);
+
+    private:
+        typedef struct {
+            frame_idx_t head;
+            frame_idx_t tail;
+            // (includes the untouched frames)
+            uint64_t size;
+            uint64_t n_untouched;
+            page_id_t untouched_page;
+        } queue_t;
+
+        std::vector<frame_meta_t> frames;
+        std::vector<queue_t> queues;
+};
+
+
+/*
+ * Inline class definitions.
+ */
+inline
+FrameQueues::FrameQueues(size_t n_queues)
+{
+    queues.resize(n_queues, {NO_FRAME, NO_FRAME, 0, 0, 0});
+}
+
+
+inline
+FrameQueues::~FrameQueues()
+{
+}
+
+
+inline void
+FrameQueues::reserve(size_t n_frames)
+{
+    frames.reserve(n_frames);
+}
+
+
+/*
+ * Allocate a fresh (zero-wear) frame in the arena. It is not yet linked into
+ * any queue.
+ * NOTE: may reallocate the arena, invalidating references to other frames.
+ */
+inline frame_idx_t
+FrameQueues::alloc_frame(page_id_t page)
+{
+    frame_idx_t f = frames.size();
+    frames.push_back({0, 0, page, NO_FRAME, NO_FRAME, 0});
+    return f;
+}
+
+
+/*
+ * Add n_frames untouched frames, all mapped to page, to the front of a queue
+ * (ahead of all of its linked frames). Only one page is kept per queue, so
+ * every call for a queue must pass the same page.
+ */
+inline void
+FrameQueues::add_untouched(uint32_t queue, uint64_t n_frames, page_id_t page)
+{
+    queue_t& q = queues[queue];
+    q.n_untouched += n_frames;
+    q.untouched_page = page;
+    q.size += n_frames;
+}
+
+
+inline FrameQueues::frame_meta_t&
+FrameQueues::operator[](frame_idx_t f)
+{
+    return frames[f];
+}
+
+
+inline size_t
+FrameQueues::get_n_frames()
+{
+    return frames.size();
+}
+
+
+inline size_t
+FrameQueues::get_n_queues()
+{
+    return queues.size();
+}
+
+
+inline void
+FrameQueues::push_back(uint32_t queue, frame_idx_t f)
+{
+    queue_t& q = queues[queue];
+    frame_meta_t& fm = frames[f];
+
+    fm.queue = queue;
+    fm.prev = q.tail;
+    fm.next = NO_FRAME;
+
+    if (q.tail == NO_FRAME) q.head = f;
+    else frames[q.tail].next = f;
+    q.tail = f;
+    ++q.size;
+}
+
+
+/*
+ * NOTE: pushes ahead of the queue's linked frames, but still behind any
+ * untouched ones.
+ */
+inline void
+FrameQueues::push_front(uint32_t queue, frame_idx_t f)
+{
+    queue_t& q = queues[queue];
+    frame_meta_t& fm = frames[f];
+
+    fm.queue = queue;
+    fm.prev = NO_FRAME;
+    fm.next = q.head;
+
+    if (q.head == NO_FRAME) q.tail = f;
+    else frames[q.head].prev = f;
+    q.head = f;
+    ++q.size;
+}
+
+
+/*
+ * Unlink a frame from whichever queue it's in. The frame keeps its queue
+ * index (as a record of where it was).
+ */
+inline void
+FrameQueues::erase(frame_idx_t f)
+{
+    frame_meta_t& fm = frames[f];
+    queue_t& q = queues[fm.queue];
+
+    if (fm.prev == NO_FRAME) q.head = fm.next;
+    else frames[fm.prev].next = fm.next;
+
+    if (fm.next == NO_FRAME) q.tail = fm.prev;
+    else frames[fm.next].prev = fm.prev;
+
+    fm.prev = NO_FRAME;
+    fm.next = NO_FRAME;
+    --q.size;
+}
+
+
+/*
+ * NOTE: if the queue has untouched frames, materializes one and returns it,
+ * which may reallocate the arena (as in alloc_frame()).
+ */
+inline frame_idx_t
+FrameQueues::pop_front(uint32_t queue)
+{
+    queue_t& q = queues[queue];
+    if (q.n_untouched == 0) {
+        frame_idx_t f = q.head;
+        erase(f);
+        return f;
+    }
+
+    --q.n_untouched;
+    --q.size;
+    frame_idx_t f = alloc_frame(q.untouched_page);
+    frames[f].queue = queue;
+    return f;
+}
+
+
+/*
+ * Head of the queue's linked frames (i.e., skipping any untouched ones).
+ */
+inline frame_idx_t
+FrameQueues::front(uint32_t queue)
+{
+    return queues[queue].head;
+}
+
+
+inline bool
+FrameQueues::empty(uint32_t queue)
+{
+    return queues[queue].size == 0;
+}
+
+
+inline uint64_t
+FrameQueues::size(uint32_t queue)
+{
+    return queues[queue].size;
+}
+
+
+inline uint64_t
+FrameQueues::get_n_untouched(uint32_t queue)
+{
+    return queues[queue].n_untouched;
+}
+
+
+inline void
+FrameQueues::save(Checkpoint& ckpt)
+{
+    ckpt.put_vector(frames);
+
+    ckpt.put((uint64_t) queues.size());
+    for (auto& q : queues) {
+        ckpt.put(q.head);
+        ckpt.put(q.tail);
+        ckpt.put(q.size);
+        ckpt.put(q.n_untouched);
+        ckpt.put(q.untouched_page);
+    }
+}
+
+
+/*
+ * NOTE: replaces all frames and queues.
+ */
+inline void
+FrameQueues::load(Checkpoint& ckpt)
+{
+    ckpt.get_vector(frames);
+
+    uint64_t n_queues;
+    ckpt.get(n_queues);
+    if (n_queues != queues.size())
+        throw std::runtime_error("checkpoint has a different n. queues");
+
+    for (auto& q : queues) {
+        ckpt.get(q.head);
+        ckpt.get(q.tail);
+        ckpt.get(q.size);
+        ckpt.get(q.n_untouched);
+        ckpt.get(q.untouched_page);
+    }
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <stdexcept>
+
+#include "HotColdSwap.h"
+
+
+HotColdSwap::HotColdSwap(const write_stream_t& ws, const sim_config_t& cfg,
+        uint64_t n_pages_mem) : ws(ws), remap_period(cfg.remap_period)
+{
+    frame_cap = cfg.page_size * 8 * cfg.cell_write_endurance;
+
+    // start from the identity mapping; the frames past the trace's pages hold
+    // filler
+    page_frames.resize(ws.n_pages);
+    std::iota(page_frames.begin(), page_frames.end(), 0);
+    frame_pages.resize(n_pages_mem, ws.filler_page);
+    std::iota(frame_pages.begin(), frame_pages.begin() + ws.n_pages, 0);
+    frame_bfs.resize(n_pages_mem, 0);
+
+    // (all zero-wear, so already in heap order)
+    cold_heap.resize(n_pages_mem);
+    for (frame_idx_t f = 0; f < n_pages_mem; ++f) cold_heap[f] = {0, f};
+}
+
+
+HotColdSwap::~HotColdSwap()
+{
+}
+
+
+uint64_t
+HotColdSwap::get_param(const sim_config_t& cfg)
+{
+    return cfg.remap_period;
+}
+
+
+uint64_t
+HotColdSwap::get_total_bfs()
+{
+    return std::accumulate(frame_bfs.begin(), frame_bfs.end(), (uint64_t) 0);
+}
+
+
+void
+HotColdSwap::get_frame_wear(std::vector<uint64_t>& bfs)
+{
+    bfs = frame_bfs;
+}
+
+
+/*
+ * NOTE: no queues.
+ */
+void
+HotColdSwap::get_queue_sizes(std::vector<uint64_t>& queue_sizes)
+{
+    queue_sizes.clear();
+}
+
+
+/*
+ * NOTE: not supported (see Policy.h).
+ */
+uint64_t
+HotColdSwap::fast_forward(uint64_t, frame_idx_t&)
+{
+    return 0;
+}
+
+
+/*
+ * Min-heap order for std::*_heap (ties broken by frame).
+ */
+bool
+HotColdSwap::cold_entry_greater(const cold_entry_t& a, const cold_entry_t& b)
+{
+    return a.bfs != b.bfs ? a.bfs > b.bfs : a.frame > b.frame;
+}
+
+
+frame_idx_t
+HotColdSwap::get_coldest_frame()
+{
+    while (true) {
+        cold_entry_t& top = cold_heap.front();
+        if (top.bfs == frame_bfs[top.frame]) return top.frame;
+
+        // stale; re-insert with the frame's current wear
+        std::pop_heap(cold_heap.begin(), cold_heap.end(),
+                cold_entry_greater);
+        cold_heap.back().bfs = frame_bfs[cold_heap.back().frame];
+        std::push_heap(cold_heap.begin(), cold_heap.end(),
+                cold_entry_greater);
+    }
+}
+
+
+void
+HotColdSwap::swap_hot_cold()
+{
+    if (hot_frame == NO_FRAME) return;
+
+    frame_idx_t cold_frame = get_coldest_frame();
+    if (frame_bfs[cold_frame] >= frame_bfs[hot_frame]) return;
+
+    std::swap(frame_pages[hot_frame], frame_pages[cold_frame]);
+    if (frame_pages[hot_frame] != ws.filler_page)
+        page_frames[frame_pages[hot_frame]] = hot_frame;
+    if (frame_pages[cold_frame] != ws.filler_page)
+        page_frames[frame_pages[cold_frame]] = cold_frame;
+
+    // apply the swap write itself to both frames, as the newly-mapped page's
+    // bfpw (as BucketQueues does)
+    frame_bfs[hot_frame] += ws.page_bfpws[frame_pages[hot_frame]];
+    frame_bfs[cold_frame] += ws.page_bfpws[frame_pages[cold_frame]];
+
+    ++n_swaps;
+    last_remap = {{hot_frame, cold_frame},
+            {ws.page_bfpws[frame_pages[hot_frame]],
+            ws.page_bfpws[frame_pages[cold_frame]]}};
+}
+
+
+void
+HotColdSwap::print_config()
+{
+    printf("policy: hot-cold\n");
+    printf("swap period (writes): %zu\n", remap_period);
+    printf("frame cap: %zu\n", frame_cap);
+}
+
+
+void
+HotColdSwap::dump_config(std::stringstream& ss)
+{
+    ss << "POLICY" << " " << "hot-cold" << std::endl;
+    ss << PARAM_NAME << " " << remap_period << std::endl;
+}
+
+
+void
+HotColdSwap::dump_stats(std::stringstream& ss, frame_idx_t)
+{
+    ss << "LEAST_WRITTEN_FRAME_BFS" << " " <<
+            *std::min_element(frame_bfs.begin(), frame_bfs.end()) << std::endl;
+}
+
+
+void
+HotColdSwap::save(Checkpoint& ckpt)
+{
+    ckpt.put(hot_frame);
+    ckpt.put(n_writes_since_swap);
+    ckpt.put(n_swaps);
+    ckpt.put_vector(page_frames);
+    ckpt.put_vector(frame_pages);
+    ckpt.put_vector(frame_bfs);
+    ckpt.put_vector(cold_heap);
+}
+
+
+void
+HotColdSwap::load(Checkpoint& ckpt)
+{
+    size_t n_frames = frame_bfs.size();
+
+    ckpt.get(hot_frame);
+    ckpt.get(n_writes_since_swap);
+    ckpt.get(n_swaps);
+    ckpt.get_vector(page_frames);
+    ckpt.get_vector(frame_pages);
+    ckpt.get_vector(frame_bfs);
+    ckpt.get_vector(cold_heap);
+
+    if (page_frames.size() != ws.n_pages or frame_pages.size() != n_frames or
+            frame_bfs.size() != n_frames or cold_heap.size() != n_frames)
+        throw std::runtime_error("checkpoint is truncated or corrupt");
+
+    // (a shorter remap period than the saved run's)
+    if (n_writes_since_swap >= remap_period) n_writes_since_swap = 0;
+}
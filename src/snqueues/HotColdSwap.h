@@ -0,0 +1,132 @@
+/*
+ * A table-based hot/cold swapping wear-leveling policy: pages are mapped to
+ * frames through a full table, and at the end of every remap period writes,
+ * the most-worn frame written during the period (hot) swaps its page with the
+ * least-worn frame in memory (cold), costing a write of each, as long as the
+ * cold frame is strictly less worn. End of life is when a written frame
+ * reaches its endurance.
+ * The least-worn frame is found through a min-heap of (wear, frame) entries
+ * that's only brought up to date lazily, when a stale entry reaches the top;
+ * since wear only grows, the top is then the true minimum, and each write
+ * causes at most one re-insertion.
+ */
+#pragma once
+
+#include <cstdbool>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include "Checkpoint.h"
+#include "FrameQueues.h"
+#include "Policy.h"
+#include "WriteStream.h"
+
+
+class HotColdSwap {
+    public:
+        HotColdSwap(const write_stream_t& ws, const sim_config_t& cfg,
+                uint64_t n_pages_mem);
+        HotColdSwap(const HotColdSwap& hcs) = delete;
+        HotColdSwap& operator=(const HotColdSwap& hcs) = delete;
+        HotColdSwap(HotColdSwap&& hcs) = delete;
+        HotColdSwap& operator=(HotColdSwap&& hcs) = delete;
+        ~HotColdSwap();
+
+        inline bool write(page_id_t p, uint64_t page_bfpw, uint64_t n_writes,
+                frame_idx_t& f);
+        inline uint64_t get_lifetime_bfs(frame_idx_t f);
+        uint64_t get_total_bfs();
+        void get_frame_wear(std::vector<uint64_t>& bfs);
+        void get_queue_sizes(std::vector<uint64_t>& queue_sizes);
+        inline uint64_t get_n_remaps();
+        inline const remap_t& get_last_remap();
+        uint64_t fast_forward(uint64_t max_n_passes,
+                frame_idx_t& most_written_frame);
+
+        void print_config();
+        void dump_config(std::stringstream& ss);
+        void dump_stats(std::stringstream& ss, frame_idx_t most_written_frame);
+        void save(Checkpoint& ckpt);
+        void load(Checkpoint& ckpt);
+
+        static uint64_t get_param(const sim_config_t& cfg);
+
+        static constexpr policy_t ID = POLICY_HOT_COLD_SWAP;
+        static constexpr bool CAN_FAST_FORWARD = false;
+        static constexpr const char* PARAM_NAME = "REMAP_PERIOD_WRITES";
+        static constexpr const char* N_REMAPS_NAME = "TOTAL_N_HOT_COLD_SWAPS";
+
+    private:
+        typedef struct {
+            uint64_t bfs;
+            frame_idx_t frame;
+        } cold_entry_t;
+
+        static bool cold_entry_greater(const cold_entry_t& a,
+                const cold_entry_t& b);
+        void swap_hot_cold();
+        frame_idx_t get_coldest_frame();
+
+        const write_stream_t& ws;
+        uint64_t remap_period;
+        uint64_t frame_cap;
+
+        // internal mechanics
+        // by page ID (excluding filler_page)
+        std::vector<frame_idx_t> page_frames;
+        // by frame
+        std::vector<page_id_t> frame_pages;
+        std::vector<uint64_t> frame_bfs;
+        std::vector<cold_entry_t> cold_heap;
+        frame_idx_t hot_frame = NO_FRAME;
+        uint64_t n_writes_since_swap = 0;
+        uint64_t n_swaps = 0;
+        remap_t last_remap = {{NO_FRAME, NO_FRAME}, {0, 0}};
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline bool
+HotColdSwap::write(page_id_t p, uint64_t page_bfpw, uint64_t n_writes,
+        frame_idx_t& f)
+{
+    f = page_frames[p];
+    frame_bfs[f] += page_bfpw;
+    bool alive = frame_bfs[f] < frame_cap;
+
+    if (hot_frame == NO_FRAME or frame_bfs[f] > frame_bfs[hot_frame])
+        hot_frame = f;
+
+    n_writes_since_swap += n_writes;
+    while (n_writes_since_swap >= remap_period) {
+        n_writes_since_swap -= remap_period;
+        swap_hot_cold();
+        hot_frame = NO_FRAME;
+    }
+
+    return alive;
+}
+
+
+inline uint64_t
+HotColdSwap::get_lifetime_bfs(frame_idx_t f)
+{
+    return frame_bfs[f];
+}
+
+
+inline uint64_t
+HotColdSwap::get_n_remaps()
+{
+    return n_swaps;
+}
+
+
+inline const remap_t&
+HotColdSwap::get_last_remap()
+{
+    return last_remap;
+}
@@ -0,0 +1,127 @@
+#include <cstdio>
+#include <stdexcept>
+
+#include "LineWear.h"
+
+
+LineWear::LineWear(const sim_config_t& cfg, uint64_t n_frames) :
+        lines_per_page(cfg.page_size / cfg.line_size),
+        line_rotation(cfg.line_rotation % (cfg.page_size / cfg.line_size))
+{
+    // set some derived variables
+    line_cap = cfg.line_size * 8 * cfg.cell_write_endurance;
+    uint64_t line_cap_n_bits = (sizeof(line_cap) * 8) -
+            __builtin_clzll(line_cap);
+    shift = line_cap_n_bits > 32 ? line_cap_n_bits - 32 : 0;
+    counter_cap = line_cap >> shift;
+
+    line_counters.resize(n_frames * lines_per_page, 0);
+    frame_line_offsets.resize(n_frames, 0);
+}
+
+
+LineWear::~LineWear()
+{
+}
+
+
+/*
+ * The page is (re)written into f at the next rotation, as a whole: every line
+ * of the frame takes its write.
+ */
+bool
+LineWear::remap(frame_idx_t f, uint64_t bfpw)
+{
+    frame_line_offsets[f] = (frame_line_offsets[f] + line_rotation) &
+            (lines_per_page - 1);
+
+    bool alive = true;
+    uint64_t first_line_idx = f * lines_per_page;
+    for (uint64_t l = 0; l < lines_per_page; ++l) {
+        alive = add(first_line_idx + l, bfpw) and alive;
+    }
+
+    return alive;
+}
+
+
+void
+LineWear::print_config()
+{
+    printf("lines per page: %zu\n", lines_per_page);
+    printf("line rotation: %zu\n", line_rotation);
+    printf("line cap: %zu\n", line_cap);
+    if (shift != 0)
+        printf("line counter unit (bit flips): %zu\n",
+                ((uint64_t) 1) << shift);
+}
+
+
+void
+LineWear::dump_config(std::stringstream& ss)
+{
+    ss << "LINE_WEAR" << " " << "on" << std::endl;
+    ss << "LINES_PER_PAGE" << " " << lines_per_page << std::endl;
+    ss << "LINE_ROTATION" << " " << line_rotation << std::endl;
+}
+
+
+void
+LineWear::dump_stats(std::stringstream& ss)
+{
+    ss << "MOST_WRITTEN_LINE_FRAME_IDX" << " " <<
+            most_written_line / lines_per_page << std::endl;
+    ss << "MOST_WRITTEN_LINE_IDX" << " " <<
+            most_written_line % lines_per_page << std::endl;
+    ss << "MOST_WRITTEN_LINE_BFS" << " " << get_most_written_line_bfs() <<
+            std::endl;
+    ss << "MOST_WRITTEN_LINE_WEAR_PCT" << " " <<
+            get_most_written_line_wear_pct() << std::endl;
+}
+
+
+void
+LineWear::save(Checkpoint& ckpt)
+{
+    ckpt.put(lines_per_page);
+    ckpt.put(shift);
+    ckpt.put(rng_state);
+    ckpt.put(most_written_line);
+    ckpt.put_vector(line_counters);
+    ckpt.put_vector(frame_line_offsets);
+}
+
+
+/*
+ * NOTE: the rotation may differ from the saved run's, and so may the
+ * endurance, as long as the counters' unit (shift) stays the same.
+ */
+void
+LineWear::load(Checkpoint& ckpt)
+{
+    uint64_t ckpt_lines_per_page, ckpt_shift;
+    ckpt.get(ckpt_lines_per_page);
+    ckpt.get(ckpt_shift);
+    if (ckpt_lines_per_page != lines_per_page)
+        throw std::runtime_error("checkpoint has a different n. lines per "
+                "page");
+    if (ckpt_shift != shift)
+        throw std::runtime_error("checkpoint has a different line counter "
+                "unit (i.e., too different an endurance)");
+
+    size_t n_frames = frame_line_offsets.size();
+    ckpt.get(rng_state);
+    ckpt.get(most_written_line);
+    ckpt.get_vector(line_counters);
+    ckpt.get_vector(frame_line_offsets);
+
+    if (frame_line_offsets.size() != n_frames or
+            line_counters.size() != n_frames * lines_per_page or
+            most_written_line >= line_counters.size())
+        throw std::runtime_error("checkpoint is truncated or corrupt");
+
+    // (a lower endurance may have already worn lines out)
+    for (auto& counter : line_counters) {
+        counter = (uint32_t) std::min((uint64_t) counter, counter_cap);
+    }
+}
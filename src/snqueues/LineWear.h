@@ -0,0 +1,119 @@
+/*
+ * Line-granularity wear for SNQueues: alongside whichever policy does the
+ * frame-level wear-leveling, tracks the bit flips taken by every line of
+ * every frame, so that end of life is when the most-written *line* (rather
+ * than frame) reaches its endurance. Optionally, each frame's page contents
+ * are rotated by a fixed n. lines every time a remap writes a page into it
+ * (intra-frame wear-leveling), spreading a hot line's writes across the
+ * frame's lines.
+ * The counters are one flat arena of 32-bit, saturating counters. When a
+ * line's bit budget (bits per line * endurance) doesn't fit in 32 bits, they
+ * count in units of 2^shift bit flips instead, with the remainder of each
+ * write stochastically rounded, so that wear is unbiased on average.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cstdbool>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include "Checkpoint.h"
+#include "FrameQueues.h"
+#include "Policy.h"
+
+
+class LineWear {
+    public:
+        LineWear(const sim_config_t& cfg, uint64_t n_frames);
+        LineWear(const LineWear& lw) = delete;
+        LineWear& operator=(const LineWear& lw) = delete;
+        LineWear(LineWear&& lw) = delete;
+        LineWear& operator=(LineWear&& lw) = delete;
+        ~LineWear();
+
+        // apply bfpw bits flipped to line (of the page) in frame f; returns
+        // false iff that line has now reached its endurance
+        inline bool write(frame_idx_t f, uint64_t line, uint64_t bfpw);
+        // a remap wrote a whole page of bfpw bits flipped per line into f
+        bool remap(frame_idx_t f, uint64_t bfpw);
+        inline uint64_t get_most_written_line_bfs();
+        inline double get_most_written_line_wear_pct();
+
+        void print_config();
+        void dump_config(std::stringstream& ss);
+        void dump_stats(std::stringstream& ss);
+        void save(Checkpoint& ckpt);
+        void load(Checkpoint& ckpt);
+
+    private:
+        inline bool add(uint64_t line_idx, uint64_t bfs);
+
+        uint64_t lines_per_page;
+        uint64_t line_rotation;
+
+        // derived
+        uint64_t line_cap;
+        uint64_t shift;
+        uint64_t counter_cap;
+
+        // internal mechanics
+        // by frame * lines_per_page + (physical) line
+        std::vector<uint32_t> line_counters;
+        // by frame; the line the page's line 0 is currently stored in
+        std::vector<uint16_t> frame_line_offsets;
+        uint64_t rng_state = 0x9e3779b97f4a7c15;
+
+        // memoize to keep the per-write check O(1)
+        uint64_t most_written_line = 0;
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline bool
+LineWear::add(uint64_t line_idx, uint64_t bfs)
+{
+    uint64_t n_units = bfs >> shift;
+    if (shift != 0) {
+        // (xorshift64)
+        rng_state ^= rng_state << 13;
+        rng_state ^= rng_state >> 7;
+        rng_state ^= rng_state << 17;
+        uint64_t unit_mask = (((uint64_t) 1) << shift) - 1;
+        if ((rng_state & unit_mask) < (bfs & unit_mask)) ++n_units;
+    }
+
+    uint32_t& counter = line_counters[line_idx];
+    counter = (uint32_t) std::min(counter + n_units, counter_cap);
+
+    if (counter > line_counters[most_written_line])
+        most_written_line = line_idx;
+
+    return counter < counter_cap;
+}
+
+
+inline bool
+LineWear::write(frame_idx_t f, uint64_t line, uint64_t bfpw)
+{
+    uint64_t physical_line = (line + frame_line_offsets[f]) &
+            (lines_per_page - 1);
+    return add(f * lines_per_page + physical_line, bfpw);
+}
+
+
+inline uint64_t
+LineWear::get_most_written_line_bfs()
+{
+    return ((uint64_t) line_counters[most_written_line]) << shift;
+}
+
+
+inline double
+LineWear::get_most_written_line_wear_pct()
+{
+    return (double) line_counters[most_written_line] / (double) counter_cap;
+}
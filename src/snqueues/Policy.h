@@ -0,0 +1,112 @@
+/*
+ * What's shared between SNQueues' wear-leveling policies: which policy to
+ * simulate, and the configuration of one simulation.
+ *
+ * A policy is a class that owns the page -> frame mapping and the frames'
+ * wear, and is plugged into Simulation<Policy> as a template parameter, so
+ * that its per-write logic is inlined into the replay loop. It provides:
+ *     Policy(const write_stream_t& ws, const sim_config_t& cfg,
+ *             uint64_t n_pages_mem);
+ *     // apply n_writes writes to page p, flipping bfpw bits in total (one
+ *     // write, except in a coalesced stream: see write_t), plus whatever
+ *     // remapping that triggers; sets f to the frame written, and returns
+ *     // false iff the memory has now reached end of life
+ *     inline bool write(page_id_t p, uint64_t bfpw, uint64_t n_writes,
+ *             frame_idx_t& f);
+ *     inline uint64_t get_lifetime_bfs(frame_idx_t f);
+ *     inline uint64_t get_total_bfs();
+ *     // every frame's lifetime bfs, by frame index, into bfs
+ *     void get_frame_wear(std::vector<uint64_t>& bfs);
+ *     // the n. frames in each queue, into queue_sizes (left empty if the
+ *     // policy has no queues)
+ *     void get_queue_sizes(std::vector<uint64_t>& queue_sizes);
+ *     inline uint64_t get_n_remaps();
+ *     // the frames written by the latest remap (see remap_t)
+ *     inline const remap_t& get_last_remap();
+ *     // skip up to max_n_passes whole passes, at a pass boundary; returns the
+ *     // n. passes skipped (only called if CAN_FAST_FORWARD)
+ *     uint64_t fast_forward(uint64_t max_n_passes,
+ *             frame_idx_t& most_written_frame);
+ *     void print_config();
+ *     void dump_config(std::stringstream& ss);
+ *     void dump_stats(std::stringstream& ss, frame_idx_t most_written_frame);
+ *     void save(Checkpoint& ckpt);
+ *     void load(Checkpoint& ckpt);
+ *     static uint64_t get_param(const sim_config_t& cfg);
+ *     static constexpr policy_t ID;
+ *     static constexpr bool CAN_FAST_FORWARD;
+ *     // (stats key names of get_param() and get_n_remaps())
+ *     static constexpr const char* PARAM_NAME;
+ *     static constexpr const char* N_REMAPS_NAME;
+ * NOTE: there is no corresponding .cpp file.
+ */
+#pragma once
+
+#include <cstdbool>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FrameQueues.h"
+
+
+typedef enum {
+    POLICY_BUCKETS,
+    POLICY_START_GAP,
+    POLICY_SECURITY_REFRESH,
+    POLICY_HOT_COLD_SWAP,
+    POLICY_INVALID
+} policy_t;
+
+
+// the distribution per-frame cell write endurances are drawn from
+typedef enum {
+    // every frame has exactly the cell write endurance
+    ENDURANCE_DIST_FIXED,
+    ENDURANCE_DIST_NORMAL,
+    ENDURANCE_DIST_LOGNORMAL,
+    ENDURANCE_DIST_INVALID
+} endurance_dist_t;
+
+
+// the (one or two) frames a remap moved pages into, each with the bfpw of the
+// page it now holds; frames[1] is NO_FRAME if only one was written
+typedef struct {
+    frame_idx_t frames[2];
+    uint64_t bfpws[2];
+} remap_t;
+
+
+// everything that may differ between simulations of the same stream
+typedef struct {
+    policy_t policy;
+    // (POLICY_BUCKETS only)
+    uint64_t n_buckets;
+    // n. writes between remapping steps (all but POLICY_BUCKETS)
+    uint64_t remap_period;
+    uint64_t cell_write_endurance;
+    uint64_t n_bytes_requested;
+    uint64_t page_size;
+    uint64_t line_size;
+    double trace_time_s;
+    uint64_t n_iterations;
+    bool fast_forward;
+    // line-granularity wear (see LineWear.h), and its intra-frame rotation
+    bool line_wear;
+    uint64_t line_rotation;
+    // per-frame endurance variation: the distribution, with the cell write
+    // endurance as its mean, its coefficient of variation, and the seed
+    endurance_dist_t endurance_dist;
+    double endurance_cov;
+    uint64_t endurance_seed;
+    // stop once the end of life extrapolated from two windows (of at least
+    // converge_window passes) agrees to this much (relative), and keeps
+    // agreeing (0: run to end of life)
+    double converge_tol;
+    uint64_t converge_window;
+    // migration cost model: the memory's bandwidth, in bytes/s (0: off), and
+    // whether remaps' page copies stall the system (else, they run in the
+    // background, only stalling it where they exceed the spare bandwidth)
+    uint64_t migration_bw;
+    bool migration_blocking;
+} sim_config_t;
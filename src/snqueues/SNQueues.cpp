@@ -1,13 +1,20 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <cstdbool>
 #include <cstdio>
+#include <fcntl.h>
 #include <iterator>
 #include <filesystem>
 #include <iostream>
 #include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
+#include "../common/SortAggregator.h"
 #include "../common/util.h"
+#include "BucketQueues.h"
 #include "SNQueues.h"
 
 
@@ -17,47 +24,41 @@ SNQueues::SNQueues(int argc, char* argv[])
 
     read_bittrack_files();
 
-    std::string memtrace_filepath = memtrace_directory + "/" + "memtrace.bin";
-    mtr.load(memtrace_filepath);
-
-    // set some derived variables
-    bucket_cap = bits_per_page * cell_write_endurance;
-    bucket_interval = bucket_cap / n_buckets;
-
-    n_pages_requested = n_bytes_requested / page_size;
-
-    printf("n. buckets: %zu\n", n_buckets);
-    printf("bucket interval: %zu\n", bucket_interval);
-    printf("bucket cap: %zu\n", bucket_cap);
-
-    if (bucket_interval < bits_per_page)
+    // everything but n. buckets (or remap period), endurance and memory size
+    // is shared by all configurations in a sweep
+    // (in super-frame mode, the simulations' "pages" are super-pages)
+    base_config = {policy, n_buckets, remap_period, cell_write_endurance,
+            n_bytes_requested, page_size << super_frame_shift, line_size,
+            trace_time_s,
+            n_iterations, (bool) fast_forward_enabled,
+            (bool) line_wear_enabled, line_rotation, endurance_dist,
+            endurance_cov, endurance_seed, converge_tol, converge_window,
+            migration_bw, (bool) migration_blocking_enabled};
+
+    if (dram_cache_size != 0 and
+            dram_cache_size / line_size < dram_cache_n_ways)
+        print_message_and_die("DRAM cache size (-D) must be >= its n. ways "
+                "(-W) times the BitTrack block size");
+
+    if (sweep_filepath == "" and
+            n_bytes_requested / n_domains < base_config.page_size)
+        print_message_and_die("each domain (-o) must get at least one page "
+                "(or super-frame, -F) of the requested memory size (-g)");
+
+    if (sweep_filepath != "") parse_sweep_file();
+    else if (policy == POLICY_BUCKETS and
+            BucketQueues::get_bucket_interval(base_config) <
+            base_config.page_size * 8)
         print_message_and_die("bucket interval must be >= bits per page to "
                 "avoid skipping buckets");
 
-    // if we're outputting a trace of promotion cycles, remember the last cycle
-    // in the trace, so that we can scale by it as we loop through
-    if (n_promotions_to_event_trace != 0) {
-        MemTraceReader::memtrace_entry_t last_entry;
-        mtr.get_last_entry(last_entry);
-        trace_end_cycle = last_entry.cycle;
-        event_trace = std::make_unique<std::ofstream>(
-                "snqueues-promotion-timestamps-uint64.bin",
-                std::ofstream::out | std::ofstream::binary);
-    }
-
-    // preallocate space in some data structures
-    queues_vec.resize(n_buckets);
+    std::string memtrace_filepath = memtrace_directory + "/" + "memtrace.bin";
+    mtr.load(memtrace_filepath);
 }
 
 
 SNQueues::~SNQueues()
 {
-    // free all entries in the queues
-    for (auto& q : queues_vec) {
-        for (auto& f : q) {
-            delete f;
-        }
-    }
 }
 
 
@@ -67,15 +68,59 @@ SNQueues::parse_and_validate_args(int argc, char* argv[])
     int c;
     optind = 0; // global: clear previous getopt() state, if any
     opterr = 0; // global: don't explicitly warn on unrecognized args
-    int n_args_parsed = 0;
 
     // sentinels
+    // (optional; defaults to bucketed queues)
+    policy_str = "buckets";
+    policy = POLICY_BUCKETS;
     n_buckets = 0;
+    // (optional; defaults to DEFAULT_REMAP_PERIOD for all but buckets)
+    remap_period = 0;
     cell_write_endurance = 0;
     bittrack_directory = "";
     memtrace_directory = "";
     write_factor_mode_str = "";
     write_factor_mode = WF_MODE_INVALID;
+    // (optional; defaults to the sorted/dense table)
+    aggregation_mode_str = "sort";
+    aggregation_mode = AGGREGATION_MODE_SORT;
+    // (optional; defaults to off)
+    fast_forward_enabled = 0;
+    // (optional; sweep mode only if supplied)
+    sweep_filepath = "";
+    // (optional; no checkpointing, and a fresh start, unless supplied)
+    checkpoint_interval = 0;
+    resume_filepath = "";
+    // (optional; defaults to wear-leveling the memory as one domain)
+    n_domains = 1;
+    // (optional; defaults to frame-granularity wear, without rotation)
+    line_wear_enabled = 0;
+    line_rotation = 0;
+    // (optional; defaults to every frame having exactly the endurance)
+    endurance_dist_str = "";
+    endurance_dist = ENDURANCE_DIST_FIXED;
+    endurance_cov = 0.0;
+    // (optional; only with an endurance distribution)
+    n_trials = 0;
+    endurance_seed = 1;
+    // (optional; defaults to running to end of life)
+    converge_tol = 0.0;
+    converge_window = 0;
+    // (optional; defaults to exact, page-level frames)
+    super_frame_shift = 0;
+    calibrate_enabled = 0;
+    // (optional; defaults to off)
+    footprint_cache_enabled = 0;
+    // (optional; defaults to no DRAM cache in front of the memory)
+    dram_cache_size = 0;
+    dram_cache_n_ways = 0;
+    // (optional; defaults to no migration cost model)
+    migration_bw = 0;
+    migration_blocking_enabled = 0;
+    migration_window_cycles = 0;
+    // (optional; defaults to no telemetry)
+    telemetry_enabled = 0;
+    telemetry_interval = 0;
     trace_time_s = 0.0;
     n_bytes_requested = 0;
     line_size = 0;
@@ -83,8 +128,36 @@ SNQueues::parse_and_validate_args(int argc, char* argv[])
     line_size_log2 = 0;
     page_size_log2 = 0;
 
+    // (long-only spellings, for the less common options)
+    static const struct option long_options[] = {
+        {"checkpoint-interval", required_argument, 0, 'k'},
+        {"resume", required_argument, 0, 'r'},
+        {"domains", required_argument, 0, 'o'},
+        {"line-wear", required_argument, 0, 'l'},
+        {"line-rotation", required_argument, 0, 'j'},
+        {"endurance-dist", required_argument, 0, 'v'},
+        {"endurance-cov", required_argument, 0, 'u'},
+        {"trials", required_argument, 0, 'x'},
+        {"seed", required_argument, 0, 'y'},
+        {"converge", required_argument, 0, 'z'},
+        {"converge-window", required_argument, 0, 'q'},
+        {"super-frame-shift", required_argument, 0, 'F'},
+        {"calibrate", required_argument, 0, 'C'},
+        {"footprint-cache", required_argument, 0, 'P'},
+        {"dram-cache", required_argument, 0, 'D'},
+        {"dram-cache-ways", required_argument, 0, 'W'},
+        {"migration-bw", required_argument, 0, 'M'},
+        {"migration-blocking", required_argument, 0, 'B'},
+        {"migration-window", required_argument, 0, 'T'},
+        {"telemetry", required_argument, 0, 'Y'},
+        {"telemetry-interval", required_argument, 0, 'I'},
+        {0, 0, 0, 0}
+    };
+
     // parse
-    while ((c = getopt(argc, argv, "n:c:b:m:w:t:i:e:g:")) != -1) {
+    while ((c = getopt_long(argc, argv,
+            "n:c:b:m:w:t:i:e:g:a:f:s:k:r:p:d:o:l:j:v:u:x:y:z:q:F:C:P:D:W:M:B:"
+            "T:Y:I:", long_options, nullptr)) != -1) {
         try {
             switch (c) {
                 case 'n':
@@ -138,6 +211,95 @@ SNQueues::parse_and_validate_args(int argc, char* argv[])
                 case 'g':
                     n_bytes_requested = shorthand_to_integer(optarg, 1024);
                     break;
+                case 'a':
+                    aggregation_mode_str = optarg;
+                    std::transform(aggregation_mode_str.begin(),
+                            aggregation_mode_str.end(),
+                            aggregation_mode_str.begin(), ::tolower);
+                    if (aggregation_mode_str == "hash")
+                        aggregation_mode = AGGREGATION_MODE_HASH;
+                    else if (aggregation_mode_str == "sort")
+                        aggregation_mode = AGGREGATION_MODE_SORT;
+                    else aggregation_mode = AGGREGATION_MODE_INVALID;
+                    break;
+                case 'f':
+                    fast_forward_enabled = string_to_boolean(optarg);
+                    break;
+                case 's':
+                    sweep_filepath = optarg;
+                    break;
+                case 'k':
+                    checkpoint_interval = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'r':
+                    resume_filepath = optarg;
+                    break;
+                case 'p':
+                    policy_str = optarg;
+                    policy = parse_policy(policy_str);
+                    break;
+                case 'd':
+                    remap_period = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'o':
+                    n_domains = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'l':
+                    line_wear_enabled = string_to_boolean(optarg);
+                    break;
+                case 'j':
+                    line_rotation = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'v':
+                    endurance_dist_str = optarg;
+                    endurance_dist = parse_endurance_dist(endurance_dist_str);
+                    break;
+                case 'u':
+                    endurance_cov = std::stod(optarg);
+                    break;
+                case 'x':
+                    n_trials = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'y':
+                    endurance_seed = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'z':
+                    converge_tol = std::stod(optarg);
+                    break;
+                case 'q':
+                    converge_window = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'F':
+                    super_frame_shift = std::stoull(optarg);
+                    break;
+                case 'C':
+                    calibrate_enabled = string_to_boolean(optarg);
+                    break;
+                case 'P':
+                    footprint_cache_enabled = string_to_boolean(optarg);
+                    break;
+                case 'D':
+                    dram_cache_size = shorthand_to_integer(optarg, 1024);
+                    break;
+                case 'W':
+                    dram_cache_n_ways = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'M':
+                    migration_bw = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'B':
+                    migration_blocking_enabled = string_to_boolean(optarg);
+                    break;
+                case 'T':
+                    migration_window_cycles = shorthand_to_integer(optarg,
+                            1000);
+                    break;
+                case 'Y':
+                    telemetry_enabled = string_to_boolean(optarg);
+                    break;
+                case 'I':
+                    telemetry_interval = shorthand_to_integer(optarg, 1000);
+                    break;
                 case '?':
                     print_message_and_die("unrecognized argument");
             }
@@ -145,21 +307,76 @@ SNQueues::parse_and_validate_args(int argc, char* argv[])
         catch (...) {
             print_message_and_die("generic arg parse failure");
         }
-        ++n_args_parsed;
     }
 
 
     // and validate
-    // the executable itself (1) plus each arg matched w/its preceding flag (*2)
-    int argc_expected = 1 + (2 * n_args_parsed);
-    if (argc != argc_expected)
+    // (every flag takes its argument, whether as "-x v", "--xx v" or
+    // "--xx=v", so nothing may be left over)
+    if (optind != argc)
         print_message_and_die("each argument must be accompanied by a flag");
 
-    if (n_buckets == 0)
-        print_message_and_die("must supply n. buckets (-n)");
+    if (policy == POLICY_INVALID)
+        print_message_and_die("wear-leveling policy (-p) must be buckets, "
+                "start-gap, security-refresh or hot-cold");
+
+    if (policy == POLICY_BUCKETS) {
+        if (remap_period != 0)
+            print_message_and_die("remap period (-d) does not apply to the "
+                    "buckets policy");
+    }
+    else {
+        if (n_buckets != 0)
+            print_message_and_die("n. buckets (-n) only applies to the "
+                    "buckets policy");
+
+        if (fast_forward_enabled == 1)
+            print_message_and_die("fast-forward (-f) is only supported by "
+                    "the buckets policy");
+    }
+
+    if (__builtin_popcountll(n_domains) != 1)
+        print_message_and_die("n. domains (-o) must be a power of two");
+
+    if (n_domains > 1) {
+        if (sweep_filepath != "")
+            print_message_and_die("multiple domains (-o) are not supported in "
+                    "sweep mode (-s)");
+
+        if (n_promotions_to_event_trace != 0)
+            print_message_and_die("promotion event tracing (-e) is not "
+                    "supported with multiple domains (-o)");
+
+        if (checkpoint_interval != 0 or resume_filepath != "")
+            print_message_and_die("checkpointing (-k) and resuming (-r) are "
+                    "not supported with multiple domains (-o)");
+    }
+
+    if (sweep_filepath != "") {
+        if (n_buckets != 0 or remap_period != 0 or
+                cell_write_endurance != 0 or n_bytes_requested != 0)
+            print_message_and_die("in sweep mode (-s), n. buckets (or remap "
+                    "period), endurance and memory size come from the sweep "
+                    "file; don't supply -n, -d, -c or -g");
 
-    if (cell_write_endurance == 0)
-        print_message_and_die("must supply cell write endurance (-c)");
+        if (n_promotions_to_event_trace != 0)
+            print_message_and_die("promotion event tracing (-e) is not "
+                    "supported in sweep mode (-s)");
+
+        if (checkpoint_interval != 0 or resume_filepath != "")
+            print_message_and_die("checkpointing (-k) and resuming (-r) are "
+                    "not supported in sweep mode (-s)");
+    }
+    else {
+        if (policy == POLICY_BUCKETS and n_buckets == 0)
+            print_message_and_die("must supply n. buckets (-n)");
+
+        if (policy != POLICY_BUCKETS and remap_period == 0)
+            remap_period = DEFAULT_REMAP_PERIOD;
+
+        if (cell_write_endurance == 0)
+            print_message_and_die("must supply cell write endurance (-c)");
+    }
 
     if (bittrack_directory == "")
         print_message_and_die("must supply BitTrack input directory (-b)");
@@ -175,13 +392,147 @@ SNQueues::parse_and_validate_args(int argc, char* argv[])
         print_message_and_die("must supply trace time duration in seconds "
                 "(-t)");
 
-    if (n_bytes_requested == 0)
-        print_message_and_die("must supply requested memory size in bytes "
-                "(-g)");
+    if (sweep_filepath == "") {
+        if (n_bytes_requested == 0)
+            print_message_and_die("must supply requested memory size in bytes "
+                    "(-g)");
+
+        if (__builtin_popcountll(n_bytes_requested) != 1) {
+            print_message_and_die("requested memory size (-g) must be a power "
+                    "of two");
+        }
+    }
+
+    if (aggregation_mode == AGGREGATION_MODE_INVALID)
+        print_message_and_die("aggregation mode (-a) must be hash or sort");
+
+    if (fast_forward_enabled == -1)
+        print_message_and_die("could not parse fast-forward mode (-f)");
+
+    if (line_wear_enabled == -1)
+        print_message_and_die("could not parse line wear mode (-l)");
+
+    if (line_wear_enabled == 1 and fast_forward_enabled == 1)
+        print_message_and_die("fast-forward (-f) is not supported with line "
+                "wear (-l)");
+
+    if (line_wear_enabled != 1 and line_rotation != 0)
+        print_message_and_die("line rotation (-j) requires line wear (-l)");
+
+    if (converge_tol < 0.0)
+        print_message_and_die("convergence tolerance (-z) must be >= 0");
+
+    if (converge_tol == 0.0 and converge_window != 0)
+        print_message_and_die("convergence window (-q) requires a "
+                "convergence tolerance (-z)");
+
+    if (converge_tol != 0.0) {
+        if (converge_window == 0) converge_window = DEFAULT_CONVERGE_WINDOW;
+        if (converge_window < 2)
+            print_message_and_die("convergence window (-q) must be >= 2 "
+                    "passes");
+    }
+
+    if (super_frame_shift > MAX_SUPER_FRAME_SHIFT)
+        print_message_and_die("super-frame shift (-F) must be <= %zu",
+                MAX_SUPER_FRAME_SHIFT);
+
+    if (super_frame_shift != 0 and (fast_forward_enabled == 1 or
+            line_wear_enabled == 1 or endurance_dist != ENDURANCE_DIST_FIXED
+            or n_promotions_to_event_trace != 0))
+        print_message_and_die("fast-forward (-f), line wear (-l), endurance "
+                "variation (-v) and event tracing (-e) are not supported with "
+                "super-frames (-F)");
+
+    if (calibrate_enabled == -1)
+        print_message_and_die("could not parse calibration mode (-C)");
+
+    if (footprint_cache_enabled == -1)
+        print_message_and_die("could not parse footprint cache mode (-P)");
+
+    if (dram_cache_size == 0) {
+        if (dram_cache_n_ways != 0)
+            print_message_and_die("DRAM cache n. ways (-W) requires a DRAM "
+                    "cache size (-D)");
+    }
+    else {
+        if (dram_cache_n_ways == 0)
+            dram_cache_n_ways = DEFAULT_DRAM_CACHE_N_WAYS;
+
+        if (__builtin_popcountll(dram_cache_size) != 1)
+            print_message_and_die("DRAM cache size (-D) must be a power of 2");
+
+        if (__builtin_popcountll(dram_cache_n_ways) != 1)
+            print_message_and_die("DRAM cache n. ways (-W) must be a power of "
+                    "2");
+    }
+
+    if (migration_blocking_enabled == -1)
+        print_message_and_die("could not parse migration blocking mode (-B)");
+
+    if (migration_bw == 0) {
+        if (migration_blocking_enabled == 1 or migration_window_cycles != 0)
+            print_message_and_die("migration blocking mode (-B) and window "
+                    "(-T) require a migration bandwidth (-M)");
+    }
+    else if (migration_window_cycles == 0) {
+        migration_window_cycles = DEFAULT_MIGRATION_WINDOW_CYCLES;
+    }
+
+    if (telemetry_enabled == -1)
+        print_message_and_die("could not parse telemetry mode (-Y)");
+
+    if (telemetry_enabled == 1) {
+        if (sweep_filepath != "" or n_domains > 1 or
+                endurance_dist != ENDURANCE_DIST_FIXED)
+            print_message_and_die("telemetry (-Y) is not supported with -s, "
+                    "-o or -v");
+    }
+    else if (telemetry_interval != 0) {
+        print_message_and_die("telemetry interval (-I) requires telemetry "
+                "(-Y)");
+    }
+
+    if (calibrate_enabled == 1) {
+        if (super_frame_shift == 0)
+            print_message_and_die("calibration (-C) requires super-frames "
+                    "(-F)");
+
+        if (sweep_filepath != "" or n_domains > 1 or
+                n_promotions_to_event_trace != 0 or checkpoint_interval != 0
+                or resume_filepath != "")
+            print_message_and_die("calibration (-C) is not supported with "
+                    "-s, -o, -e, -k or -r");
+    }
+
+    if (endurance_dist == ENDURANCE_DIST_INVALID)
+        print_message_and_die("endurance distribution (-v) must be normal or "
+                "lognormal");
+
+    if (endurance_dist == ENDURANCE_DIST_FIXED) {
+        if (endurance_cov != 0.0 or n_trials != 0)
+            print_message_and_die("endurance CoV (-u) and n. trials (-x) "
+                    "require an endurance distribution (-v)");
+    }
+    else {
+        if (endurance_cov <= 0.0)
+            print_message_and_die("must supply a positive endurance CoV (-u)");
+
+        if (n_trials == 0) n_trials = DEFAULT_N_TRIALS;
+
+        if (sweep_filepath != "" or n_domains > 1)
+            print_message_and_die("endurance variation (-v) is not supported "
+                    "in sweep mode (-s) or with multiple domains (-o)");
 
-    if (__builtin_popcountll(n_bytes_requested) != 1) {
-        print_message_and_die("requested memory size (-g) must be a power of "
-                "two");
+        if (n_promotions_to_event_trace != 0 or checkpoint_interval != 0 or
+                resume_filepath != "")
+            print_message_and_die("promotion event tracing (-e), "
+                    "checkpointing (-k) and resuming (-r) are not supported "
+                    "with endurance variation (-v)");
+
+        if (fast_forward_enabled == 1 or line_wear_enabled == 1)
+            print_message_and_die("fast-forward (-f) and line wear (-l) are "
+                    "not supported with endurance variation (-v)");
     }
 }
 
@@ -223,6 +574,11 @@ SNQueues::read_bittrack_files()
     bits_per_line = line_size * 8;
     bits_per_page = page_size * 8;
 
+    // (write_t packs a write's bfpw and line of the page into 16 bits each)
+    if (bits_per_line > UINT16_MAX or page_size / line_size > UINT16_MAX + 1)
+        print_message_and_die("BitTrack block size must be < 8 KiB, and "
+                "<= 65536 blocks per page");
+
     // always load the average from the .txt file:
     average_wf = std::stod(bittrack_kv["P_BITFLIP_PER_WRITE"]);
     average_bfpw = (uint64_t) std::ceil(average_wf * bits_per_line);
@@ -231,243 +587,868 @@ SNQueues::read_bittrack_files()
 
     // if in per-page mode, load the bittrack.bin file
     if (write_factor_mode == WF_MODE_PER_PAGE) {
-        std::ifstream ifs(bin_filepath, std::ios::binary);
+        auto start_time = std::chrono::steady_clock::now();
+
+        if (aggregation_mode == AGGREGATION_MODE_SORT)
+            setup_page_bfpws_sort(bin_filepath);
+        else setup_page_bfpws_hash(bin_filepath);
+
+        std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start_time;
+        printf("per-page bfpw setup (%s) time (s): %f\n",
+                aggregation_mode_str.c_str(), elapsed.count());
+    }
+}
 
-        bittrack_entry_t e;
-        while (!ifs.eof()) {
-            ifs.read((char*) &e, sizeof(e));
-            page_wfs[e.page_addr] = e.page_wf;
-            //printf("PWF: %f\n", e.page_wf);
-        }
 
-        if (page_wfs.size() != std::stoull(bittrack_kv["N_PAGES_WRITTEN"]))
-            print_message_and_die("mismatch in n. pages between .txt and .bin");
+/*
+ * Fill out page_bfpws (page bits flipped per write; i.e., every time we write
+ * a line to a page, the count of how many bits expected to flip) via hashing.
+ */
+void
+SNQueues::setup_page_bfpws_hash(const std::string& bin_filepath)
+{
+    std::ifstream ifs(bin_filepath, std::ios::binary);
+    if (!ifs.is_open())
+        print_message_and_die("could not open %s", bin_filepath.c_str());
+
+    page_bfpws.reserve(std::stoull(bittrack_kv["N_PAGES_WRITTEN"]));
 
+    // (for duplicate page addrs., the last entry wins)
+    bittrack_entry_t e;
+    while (ifs.read((char*) &e, sizeof(e))) {
+        double page_bfpw_d = e.page_wf * (double) bits_per_line;
+        page_bfpws[e.page_addr] = (uint64_t) ceil(page_bfpw_d);
+    }
+
+    if (page_bfpws.size() != std::stoull(bittrack_kv["N_PAGES_WRITTEN"]))
+        print_message_and_die("mismatch in n. pages between .txt and .bin");
+}
 
-        // fill out page_bfpws (page bits flipped per write; i.e., every time we
-        // write a line to a page, the count of how many bits expected to flip)
-        for (auto& kv : page_wfs) {
-            page_addr_t page_addr = kv.first;
-            double page_wf = kv.second;
 
-            double page_bfpw_d = page_wf * (double) bits_per_line;
-            uint64_t page_bfpw_i = (uint64_t) ceil(page_bfpw_d);
+/*
+ * Sort-based equivalent of setup_page_bfpws_hash(): map the bittrack.bin file,
+ * convert its entries into compact (page addr., bfpw) records in parallel
+ * chunks, radix-sort those by page addr., and keep them either as a sorted
+ * table, which get_page_bfpw() binary-searches, or, if the written pages are
+ * dense enough, as a table indexed by page addr.
+ */
+void
+SNQueues::setup_page_bfpws_sort(const std::string& bin_filepath)
+{
+    int fd = open(bin_filepath.c_str(), O_RDONLY);
+    if (fd == -1)
+        print_message_and_die("could not open %s", bin_filepath.c_str());
+
+    struct stat st;
+    if (fstat(fd, &st) == -1)
+        print_message_and_die("could not stat %s", bin_filepath.c_str());
+    size_t n_bytes = st.st_size;
+    if (n_bytes % sizeof(bittrack_entry_t) != 0)
+        print_message_and_die("%s is not a whole n. entries",
+                bin_filepath.c_str());
+    size_t n_entries = n_bytes / sizeof(bittrack_entry_t);
+
+    void* map = nullptr;
+    if (n_bytes != 0) {
+        map = mmap(nullptr, n_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED)
+            print_message_and_die("could not map %s", bin_filepath.c_str());
+        madvise(map, n_bytes, MADV_SEQUENTIAL);
+    }
+    close(fd);
+    auto* entries = (const bittrack_entry_t*) map;
+
+    ThreadPool pool;
+    sorted_page_bfpws.resize(n_entries);
+    size_t n_chunks = std::max(pool.get_n_threads(), (size_t) 1);
+    pool.parallel_for(n_chunks, [&](size_t c) {
+        size_t lo = (n_entries * c) / n_chunks;
+        size_t hi = (n_entries * (c + 1)) / n_chunks;
+        for (size_t i = lo; i < hi; ++i) {
+            double page_bfpw_d = entries[i].page_wf * (double) bits_per_line;
+            sorted_page_bfpws[i] = {entries[i].page_addr,
+                    (uint16_t) ceil(page_bfpw_d)};
+        }
+    });
+    if (map != nullptr) munmap(map, n_bytes);
+
+    parallel_radix_sort(sorted_page_bfpws, [](const page_bfpw_t& e) {
+        return (uint64_t) e.page_addr;
+    }, pool);
+
+    // the sort is stable, so for duplicate page addrs., keeping the last entry
+    // matches the last-write-wins behavior of the hash path
+    size_t n_pages = 0;
+    for (size_t i = 0; i < sorted_page_bfpws.size(); ++i) {
+        if (i + 1 < sorted_page_bfpws.size() and
+                sorted_page_bfpws[i + 1].page_addr ==
+                sorted_page_bfpws[i].page_addr) continue;
+        sorted_page_bfpws[n_pages++] = sorted_page_bfpws[i];
+    }
+    sorted_page_bfpws.resize(n_pages);
+
+    if (n_pages != std::stoull(bittrack_kv["N_PAGES_WRITTEN"]))
+        print_message_and_die("mismatch in n. pages between .txt and .bin");
+
+    if (n_pages == 0) return;
+    uint64_t span = sorted_page_bfpws.back().page_addr -
+            sorted_page_bfpws.front().page_addr + 1;
+    if (span > MAX_DENSE_SPAN_FACTOR * n_pages) {
+        sorted_page_bfpws.shrink_to_fit();
+        printf("per-page bfpw table: sorted, %zu pages\n", n_pages);
+        return;
+    }
 
-            page_bfpws[page_addr] = page_bfpw_i;
+    dense_base_page_addr = sorted_page_bfpws.front().page_addr;
+    dense_page_bfpws.assign(span, NO_PAGE_BFPW);
+    pool.parallel_for(n_chunks, [&](size_t c) {
+        size_t lo = (n_pages * c) / n_chunks;
+        size_t hi = (n_pages * (c + 1)) / n_chunks;
+        for (size_t i = lo; i < hi; ++i) {
+            dense_page_bfpws[sorted_page_bfpws[i].page_addr -
+                    dense_base_page_addr] = sorted_page_bfpws[i].bfpw;
         }
+    });
+    std::vector<page_bfpw_t>().swap(sorted_page_bfpws);
+    printf("per-page bfpw table: dense, %zu pages over %zu page addrs.\n",
+            n_pages, span);
+}
+
 
+/*
+ * Read the sweep file: one configuration per line, as
+ *     <n. buckets> <cell write endurance> <memory size, bytes requested>
+ * (each accepting the same shorthands as -n, -c and -g), where, for policies
+ * other than buckets, the first column is instead the remap period (as -d).
+ * Blank lines and lines starting with '#' are skipped.
+ */
+void
+SNQueues::parse_sweep_file()
+{
+    std::ifstream ifs(sweep_filepath);
+    if (!ifs.is_open())
+        print_message_and_die("could not open sweep file %s",
+                sweep_filepath.c_str());
+
+    std::string line;
+    size_t line_num = 0;
+    while (std::getline(ifs, line)) {
+        ++line_num;
+        if (line.find_first_not_of(" \t") == std::string::npos or
+                line[line.find_first_not_of(" \t")] == '#') continue;
+
+        std::istringstream iss(line);
+        std::string n_str, c_str, g_str, extra_str;
+        if (!(iss >> n_str >> c_str >> g_str) or (iss >> extra_str))
+            print_message_and_die("sweep file line %zu: expected <n. buckets "
+                    "or remap period> <endurance> <memory size>", line_num);
+
+        sim_config_t cfg = base_config;
+        try {
+            if (policy == POLICY_BUCKETS)
+                cfg.n_buckets = shorthand_to_integer(n_str, 1000);
+            else cfg.remap_period = shorthand_to_integer(n_str, 1000);
+            cfg.cell_write_endurance = shorthand_to_integer(c_str, 1000);
+            cfg.n_bytes_requested = shorthand_to_integer(g_str, 1024);
+        }
+        catch (...) {
+            print_message_and_die("sweep file line %zu: could not parse",
+                    line_num);
+        }
+
+        if (cfg.n_buckets + cfg.remap_period == 0 or
+                cfg.cell_write_endurance == 0)
+            print_message_and_die("sweep file line %zu: n. buckets (or remap "
+                    "period) and endurance must be >= 1", line_num);
+
+        if (__builtin_popcountll(cfg.n_bytes_requested) != 1)
+            print_message_and_die("sweep file line %zu: requested memory size "
+                    "must be a power of two", line_num);
+
+        if (policy == POLICY_BUCKETS and
+                BucketQueues::get_bucket_interval(cfg) < cfg.page_size * 8)
+            print_message_and_die("sweep file line %zu: bucket interval must "
+                    "be >= bits per page to avoid skipping buckets", line_num);
+
+        sweep_configs.emplace_back(cfg);
     }
+
+    if (sweep_configs.empty())
+        print_message_and_die("sweep file has no configurations");
 }
 
 
+/*
+ * In a single pass through the trace, number its pages (in first-touch order),
+ * and decode its writes into domain_wss, which the simulations then replay
+ * every pass in place of the trace itself. Each page (and so its writes) goes
+ * to the domain given by its low page addr. bits (i.e., the domains are
+ * page-interleaved), and is numbered within that domain. Afterwards, the
+ * trace buffer is freed.
+ * In super-frame mode, the stream's "pages" are instead super-pages (aligned
+ * groups of 2^super_frame_shift pages), each write keeping its own page's
+ * bfpw, and the stream is coalesced (see write_stream_t) as it's decoded; and
+ * (if calibrating) the page-level stream is also decoded, into calib_ws.
+ */
 void
-SNQueues::run()
+SNQueues::prepare_write_stream()
 {
-    // first, construct all frames in the initial starting queues state
+    auto start_time = std::chrono::steady_clock::now();
+
+    domain_wss.resize(n_domains);
+    domain_page_ids.resize(n_domains);
+    uint64_t trace_end_cycle = 0;
+    uint64_t n_accesses = 0;
+    uint64_t n_trace_writes = 0;
+    // (to the memory)
+    uint64_t n_writes = 0;
+    uint64_t lines_per_page = page_size / line_size;
+    // (super-frame mode only) by page addr.; and by domain, then super-page
+    // ID, the index of its latest record in the stream
+    std::unordered_map<page_addr_t, member_page_t> member_pages;
+    std::vector<std::vector<uint64_t>> domain_record_idxs(n_domains);
+
+    // the trace's footprint: if cached, the pages are numbered (in the same
+    // first-touch order) and the stream sized before the pass; else, it's
+    // recorded during the pass, and cached afterwards
+    std::unique_ptr<FootprintCache> footprint_cache;
+    footprint_t footprint;
+    bool footprint_cached = false;
+    if (footprint_cache_enabled) {
+        footprint_cache = std::make_unique<FootprintCache>(memtrace_directory +
+                "/" + "memtrace.bin", line_size, page_size);
+        footprint_cached = footprint_cache->load(footprint);
+    }
+
+    // number page_addr's (stream) page within its domain, and resolve its
+    // bfpw, on first touch; returns the domain, and sets the page ID, the
+    // page's own bfpw and (super-frame mode only) its member_page_t
+    auto touch_page = [&](page_addr_t page_addr, page_id_t& p, uint64_t& bfpw,
+            member_page_t*& member) -> size_t {
+        page_addr_t stream_page_addr = page_addr >> super_frame_shift;
+        size_t d = stream_page_addr & (n_domains - 1);
+        auto& ws = domain_wss[d];
+        auto& page_ids = domain_page_ids[d];
+
+        auto [page_it, is_new_page] = page_ids.emplace(stream_page_addr,
+                page_ids.size());
+        p = page_it->second;
+        bool is_new_page_addr = is_new_page;
+        if (super_frame_shift == 0) {
+            // resolve each page's bfpw once, up front
+            if (is_new_page)
+                ws.page_bfpws.emplace_back(get_page_bfpw(page_addr));
+            bfpw = ws.page_bfpws[p];
+        }
+        else {
+            // a super-page's bfpw (i.e., of copying it whole) is its pages'
+            // total; pages not (yet) seen in the trace count as the average
+            if (is_new_page)
+                ws.page_bfpws.emplace_back(average_bfpw << super_frame_shift);
+            auto [member_it, is_new_member] = member_pages.emplace(page_addr,
+                    member_page_t{0, 0, false});
+            member = &member_it->second;
+            if (is_new_member) {
+                member->bfpw = get_page_bfpw(page_addr);
+                ws.page_bfpws[p] = ws.page_bfpws[p] - average_bfpw +
+                        member->bfpw;
+            }
+            bfpw = member->bfpw;
+            is_new_page_addr = is_new_member;
+        }
+
+        if (is_new_page_addr and !footprint_cached)
+            footprint.pages.emplace_back(page_addr);
+
+        if (calibrate_enabled) {
+            auto [calib_page_it, is_new_calib_page] = calib_page_ids.emplace(
+                    page_addr, calib_page_ids.size());
+            if (is_new_calib_page) calib_ws.page_bfpws.emplace_back(bfpw);
+        }
+
+        return d;
+    };
+
+    if (footprint_cached) {
+        printf("trace footprint (cached): %zu pages (%zu bytes), %zu "
+                "written\n", footprint.pages.size(),
+                footprint.pages.size() * page_size,
+                FootprintCache::get_n_write_pages(footprint));
+
+        page_id_t p;
+        uint64_t bfpw;
+        member_page_t* member;
+        for (page_addr_t page_addr : footprint.pages) {
+            touch_page(page_addr, p, bfpw, member);
+        }
+
+        // (per-domain write counts aren't cached, nor are the writes that
+        // make it past a DRAM cache, nor the coalesced stream's length)
+        if (n_domains == 1 and dram_cache_size == 0 and
+                super_frame_shift == 0) {
+            domain_wss[0].writes.reserve(footprint.n_writes);
+            if (n_promotions_to_event_trace != 0)
+                domain_wss[0].cycles.reserve(footprint.n_writes);
+        }
+        if (calibrate_enabled and dram_cache_size == 0)
+            calib_ws.writes.reserve(footprint.n_writes);
+    }
+
+    // (migration cost model only) move ws on to the window of cycle (never
+    // back; accesses with earlier cycles count toward the current window)
+    auto advance_window = [&](write_stream_t& ws, uint64_t cycle) {
+        while (ws.window_first_write_idxs.size() * migration_window_cycles <=
+                cycle) {
+            ws.window_first_write_idxs.push_back(ws.writes.size());
+            ws.window_n_accesses.push_back(0);
+        }
+    };
+
+    // (migration cost model only) count a line access to the memory, to a
+    // page in domain d
+    auto count_access = [&](size_t d, uint64_t cycle) {
+        advance_window(domain_wss[d], cycle);
+        ++domain_wss[d].window_n_accesses.back();
+        if (calibrate_enabled) {
+            advance_window(calib_ws, cycle);
+            ++calib_ws.window_n_accesses.back();
+        }
+    };
+
+    // append a write of line_addr, of page p (with bfpw) in domain d, to the
+    // stream(s)
+    auto add_write = [&](line_addr_t line_addr, size_t d, page_id_t p,
+            uint64_t bfpw, member_page_t* member, uint64_t cycle) {
+        auto& ws = domain_wss[d];
+        auto& page_ids = domain_page_ids[d];
+        uint16_t line = (uint16_t) (line_addr & (lines_per_page - 1));
+
+        if (migration_bw != 0) {
+            advance_window(ws, cycle);
+            if (calibrate_enabled) advance_window(calib_ws, cycle);
+        }
+
+        ++ws.n_writes;
+        ++n_writes;
+
+        if (calibrate_enabled) {
+            page_addr_t page_addr = line_addr_to_page_addr(line_addr,
+                    line_size_log2, page_size_log2);
+            calib_ws.writes.push_back({calib_page_ids[page_addr],
+                    (uint16_t) bfpw, line});
+        }
+
+        if (member != nullptr) {
+            member->bfs += bfpw;
+            member->is_written = true;
+
+            // merge into the super-page's latest record if that's in the
+            // same pass (or migration window), and has room
+            auto& record_idxs = domain_record_idxs[d];
+            record_idxs.resize(page_ids.size(), 0);
+            uint64_t first_idx = migration_bw == 0 ? 0 :
+                    ws.window_first_write_idxs.back();
+            uint64_t idx = record_idxs[p];
+            if (idx >= first_idx and idx < ws.writes.size() and
+                    ws.writes[idx].page == p and
+                    ws.writes[idx].bfpw + bfpw <= UINT16_MAX and
+                    ws.writes[idx].n_writes < UINT16_MAX) {
+                ws.writes[idx].bfpw += (uint16_t) bfpw;
+                ++ws.writes[idx].n_writes;
+                return;
+            }
+
+            record_idxs[p] = ws.writes.size();
+            ws.writes.push_back({p, (uint16_t) bfpw, 0});
+            ws.writes.back().n_writes = 1;
+            return;
+        }
+
+        if (fast_forward_enabled) {
+            ws.page_n_writes.resize(page_ids.size(), 0);
+            ws.page_first_write_idxs.resize(page_ids.size(), 0);
+            ws.page_last_write_idxs.resize(page_ids.size(), 0);
+            if (ws.page_n_writes[p]++ == 0)
+                ws.page_first_write_idxs[p] = ws.writes.size();
+            ws.page_last_write_idxs[p] = ws.writes.size();
+        }
+
+        ws.writes.push_back({p, (uint16_t) bfpw, line});
+        if (n_promotions_to_event_trace != 0)
+            ws.cycles.push_back(cycle);
+    };
+
+    // (only with a DRAM cache in front of the memory) only the trace's dirty
+    // evictions from it, i.e., their write-backs, reach the memory
+    std::unique_ptr<Cache> dram_cache;
+    if (dram_cache_size != 0) {
+        dram_cache = std::make_unique<Cache>(dram_cache_size / line_size, 1,
+                dram_cache_n_ways, ALLOCATION_POLICY_AORW,
+                EVICTION_POLICY_LRU, true);
+    }
+
     do {
         auto& mt = mtr.next();
         auto page_addr = line_addr_to_page_addr(mt.line_addr, line_size_log2,
                 page_size_log2);
-        if (!page_map.count(page_addr)) {
-            // allocate everything in the bottommost queue initially...
-            frame_meta_t* fm = new frame_meta_t{0, 0, 0, page_addr};
-            queues_vec[0].emplace_back(fm);
-            // ...and the page map
-            auto lq_back = std::next(queues_vec[0].end(), -1);
-            page_map.emplace(page_addr, lq_back);
+        // (ends up as the last cycle in the trace)
+        trace_end_cycle = mt.cycle;
+        ++n_accesses;
+
+        page_id_t p;
+        uint64_t bfpw;
+        member_page_t* member = nullptr;
+        size_t d = touch_page(page_addr, p, bfpw, member);
+        if (mt.is_write) {
+            ++n_trace_writes;
+            ++domain_wss[d].n_trace_writes;
+        }
 
+        if (dram_cache) {
+            line_addr_t evicted_line_addr;
+            access_result_t res = dram_cache->access(mt.line_addr,
+                    mt.is_write ? MEM_REF_TYPE_ST : MEM_REF_TYPE_LD,
+                    evicted_line_addr);
+            // (a miss fills the line from the memory)
+            if (migration_bw != 0 and !(res & ACCESS_RESULT_HIT))
+                count_access(d, mt.cycle);
+            if (!(res & ACCESS_RESULT_DIRTY_EVICTION)) continue;
+
+            d = touch_page(line_addr_to_page_addr(evicted_line_addr,
+                    line_size_log2, page_size_log2), p, bfpw, member);
+            if (migration_bw != 0) count_access(d, mt.cycle);
+            add_write(evicted_line_addr, d, p, bfpw, member, mt.cycle);
+            continue;
         }
+
+        if (migration_bw != 0) count_access(d, mt.cycle);
+
+        // ignore anything that's not a write
+        if (!mt.is_write) continue;
+
+        add_write(mt.line_addr, d, p, bfpw, member, mt.cycle);
     }
     while (!mtr.is_end_of_pass());
-    mtr.reset();
+    mtr.unload();
+
+    if (dram_cache) {
+        // write back whatever is still dirty at the end of the pass (as of
+        // its last cycle), so that every pass's writes reach the memory
+        std::vector<line_addr_t> dirty_line_addrs;
+        dram_cache->write_back(dirty_line_addrs);
+        for (line_addr_t line_addr : dirty_line_addrs) {
+            page_id_t p;
+            uint64_t bfpw;
+            member_page_t* member = nullptr;
+            size_t d = touch_page(line_addr_to_page_addr(line_addr,
+                    line_size_log2, page_size_log2), p, bfpw, member);
+            if (migration_bw != 0) count_access(d, trace_end_cycle);
+            add_write(line_addr, d, p, bfpw, member, trace_end_cycle);
+            ++domain_wss[d].n_flush_writes;
+        }
+
+        dram_cache->aggregate_stats();
+        printf("DRAM cache: %zu trace writes, %zu dirty evictions, %zu "
+                "dirty lines written back at end of pass\n", n_trace_writes,
+                dram_cache->get_n_dirty_evictions(),
+                dirty_line_addrs.size());
+        dram_cache.reset();
+        for (auto& ws : domain_wss) ws.dram_cache_size = dram_cache_size;
+    }
+
+    if (footprint_cached) {
+        uint64_t n_pages = super_frame_shift == 0 ? 0 : member_pages.size();
+        if (super_frame_shift == 0) {
+            for (auto& page_ids : domain_page_ids) n_pages += page_ids.size();
+        }
+        if (n_pages != footprint.pages.size() or
+                n_accesses != footprint.n_accesses or
+                n_trace_writes != footprint.n_writes)
+            print_message_and_die("trace does not match its cached footprint "
+                    "%s; delete it and rerun",
+                    footprint_cache->get_filepath().c_str());
+    }
+    else if (footprint_cache_enabled) {
+        record_footprint_writes(footprint, member_pages);
+        footprint.n_accesses = n_accesses;
+        footprint.n_writes = n_trace_writes;
+        if (!footprint_cache->save(footprint))
+            printf("could not cache trace footprint in %s\n",
+                    footprint_cache->get_filepath().c_str());
+    }
 
+    if (n_trace_writes == 0)
+        print_message_and_die("trace contains no writes");
 
-    /*
-     * Size the memory. If the number of pages in the trace is higher than what
-     * the user requested, set num. pages in mem. to the power of two that
-     * is >= rss. If the user requested more pages than what is in the trace,
-     * just go with that.
-     */
-    n_pages_rss = page_map.size();
-    n_bytes_rss = n_pages_rss * page_size;
+    uint64_t n_bytes = 0;
+    for (size_t d = 0; d < n_domains; ++d) {
+        auto& ws = domain_wss[d];
+        auto& page_ids = domain_page_ids[d];
 
-    if (n_pages_rss > n_pages_requested) {
-        if (__builtin_popcountll(n_bytes_rss) == 1) {
-            // perfect power of two; keep it
-            n_bytes_mem = n_bytes_rss;
+        if (page_ids.size() >= UINT32_MAX)
+            print_message_and_die("too many distinct pages in trace (max %u)",
+                    UINT32_MAX - 1);
+
+        // (every domain sees the whole trace's time)
+        ws.trace_end_cycle = trace_end_cycle;
+        if (migration_bw != 0) {
+            advance_window(ws, trace_end_cycle);
+            ws.window_cycles = migration_window_cycles;
         }
-        else {
-            uint64_t n_head_bits = (sizeof(n_bytes_rss) * 8) - 1;
-            uint64_t n_bytes_rss_log2_floor =
-                    n_head_bits - __builtin_clzll(n_bytes_rss);
-            // increment by one; next-highest
-            uint64_t n_bytes_mem_log2 = n_bytes_rss_log2_floor + 1;
-            n_bytes_mem = ((uint64_t) 1) << n_bytes_mem_log2;
-            printf("Requested memory size was < trace RSS; rounding up...\n");
+
+        ws.n_pages = page_ids.size();
+        // (pages only ever read still need entries)
+        if (fast_forward_enabled) {
+            ws.page_n_writes.resize(ws.n_pages, 0);
+            ws.page_first_write_idxs.resize(ws.n_pages, 0);
+            ws.page_last_write_idxs.resize(ws.n_pages, 0);
+        }
+
+        // the filler frames' page gets the ID one past the trace's pages
+        // (and, as before, the bfpw of page addr. 0x0)
+        ws.filler_page = ws.n_pages;
+        ws.page_bfpws.emplace_back(get_page_bfpw(0x0) << super_frame_shift);
+
+        n_bytes += ws.writes.size() * sizeof(write_t) +
+                ws.cycles.size() * sizeof(uint64_t);
+    }
+
+    if (super_frame_shift != 0) {
+        set_max_page_shares(member_pages);
+        // (done with the pages)
+        std::unordered_map<page_addr_t, member_page_t>().swap(member_pages);
+        for (auto& ws : domain_wss) ws.is_coalesced = true;
+    }
+
+    if (calibrate_enabled) {
+        calib_ws.trace_end_cycle = trace_end_cycle;
+        if (migration_bw != 0) {
+            advance_window(calib_ws, trace_end_cycle);
+            calib_ws.window_cycles = migration_window_cycles;
         }
+        calib_ws.n_pages = calib_page_ids.size();
+        calib_ws.filler_page = calib_ws.n_pages;
+        calib_ws.page_bfpws.emplace_back(get_page_bfpw(0x0));
+        calib_page_ids.clear();
     }
-    else n_bytes_mem = n_bytes_requested;
-    // set n_pages_mem too
-    n_pages_mem = n_bytes_mem / page_size;
 
-    // print some initial stats
-    printf("Beginning simulation\n");
-    printf("Global MiB in memory: %zu\n", n_bytes_mem / (1024 * 1024));
+    std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_time;
+    printf("write stream: %zu writes, %zu bytes\n", n_writes, n_bytes);
+    if (super_frame_shift != 0) {
+        uint64_t n_records = 0;
+        for (auto& ws : domain_wss) n_records += ws.writes.size();
+        printf("write stream coalesced into %zu records\n", n_records);
+    }
+    printf("write stream prep time (s): %f\n", elapsed.count());
+}
 
 
+/*
+ * Fill in which of the (recorded) footprint's pages are ever written: from
+ * the decoded stream or, in super-frame mode, from the member pages.
+ */
+void
+SNQueues::record_footprint_writes(footprint_t& footprint,
+        const std::unordered_map<page_addr_t, member_page_t>& member_pages)
+{
+    footprint.page_written.assign(footprint.pages.size(), 0);
 
-    // now, prepend the remainder free frames (up to n_pages_mem) to queue 0
-    // NOTE: this means multiple frames will represent the 0x0 page addr., but
-    // this is fine, as it's just a filler value.
-    size_t n_rem_pages = n_pages_mem - n_pages_rss;
-    for (size_t i = 0; i < n_rem_pages; ++i) {
-        frame_meta_t* fm = new frame_meta_t{0, 0, 0, 0x0};
-        queues_vec[0].emplace_front(fm);
+    if (super_frame_shift != 0) {
+        for (size_t i = 0; i < footprint.pages.size(); ++i) {
+            footprint.page_written[i] =
+                    member_pages.at(footprint.pages[i]).is_written;
+        }
+        return;
     }
 
+    // by domain, then page ID
+    std::vector<std::vector<uint8_t>> domain_page_written(n_domains);
+    for (size_t d = 0; d < n_domains; ++d) {
+        domain_page_written[d].resize(domain_page_ids[d].size(), 0);
+        for (auto& w : domain_wss[d].writes) {
+            domain_page_written[d][w.page] = 1;
+        }
+    }
 
+    for (size_t i = 0; i < footprint.pages.size(); ++i) {
+        size_t d = footprint.pages[i] & (n_domains - 1);
+        footprint.page_written[i] = domain_page_written[d][
+                domain_page_ids[d].at(footprint.pages[i])];
+    }
+}
+
+
+/*
+ * For the super-frame error bound (see write_stream_t): in each domain's
+ * stream, the largest share that any one page takes of its super-page's
+ * written bit flips (per pass), or of its bfpw (i.e., of a copy).
+ */
+void
+SNQueues::set_max_page_shares(
+        const std::unordered_map<page_addr_t, member_page_t>& member_pages)
+{
+    // (the filler page's pages all copy at the same bfpw)
+    for (auto& ws : domain_wss) {
+        ws.pages_per_frame = ((uint64_t) 1) << super_frame_shift;
+        ws.max_page_share = 1.0 / (double) ws.pages_per_frame;
+    }
+
+    // first, total up each super-page's written bfs, and n. pages seen...
+    std::vector<std::vector<uint64_t>> domain_super_bfs(n_domains);
+    std::vector<std::vector<uint64_t>> domain_n_members(n_domains);
+    for (size_t d = 0; d < n_domains; ++d) {
+        domain_super_bfs[d].resize(domain_wss[d].n_pages, 0);
+        domain_n_members[d].resize(domain_wss[d].n_pages, 0);
+    }
+
+    for (auto& [page_addr, member] : member_pages) {
+        page_addr_t super_page_addr = page_addr >> super_frame_shift;
+        size_t d = super_page_addr & (n_domains - 1);
+        page_id_t p = domain_page_ids[d][super_page_addr];
+        domain_super_bfs[d][p] += member.bfs;
+        ++domain_n_members[d][p];
+    }
+
+    // ...then take the max. share over them
+    for (auto& [page_addr, member] : member_pages) {
+        page_addr_t super_page_addr = page_addr >> super_frame_shift;
+        size_t d = super_page_addr & (n_domains - 1);
+        auto& ws = domain_wss[d];
+        page_id_t p = domain_page_ids[d][super_page_addr];
+
+        double share = (double) member.bfpw / (double) ws.page_bfpws[p];
+        if (domain_super_bfs[d][p] != 0)
+            share = std::max(share, (double) member.bfs /
+                    (double) domain_super_bfs[d][p]);
+        // (pages never seen are copied at the average bfpw)
+        if (domain_n_members[d][p] < (((uint64_t) 1) << super_frame_shift))
+            share = std::max(share, (double) average_bfpw /
+                    (double) ws.page_bfpws[p]);
+        ws.max_page_share = std::max(ws.max_page_share, share);
+    }
+}
 
-    // main loop
-    bool cont = true;
-    while (cont) {
-        if (mtr.is_end_of_pass()) {
-            system_time_s += trace_time_s;
-            dump_stats(/* final = false; incremental */);
 
-            if (mtr.get_n_full_passes() + 1 == n_iterations) break;
+void
+SNQueues::run()
+{
+    prepare_write_stream();
+
+    if (sweep_filepath != "") {
+        run_sweep();
+        return;
+    }
+
+    if (n_domains > 1) {
+        run_domains();
+        return;
+    }
+
+    if (endurance_dist != ENDURANCE_DIST_FIXED) {
+        run_trials();
+        return;
+    }
+
+    if (calibrate_enabled) {
+        run_calibration();
+        return;
+    }
+
+    sim = make_simulation(domain_wss[0], base_config);
+
+    if (resume_filepath != "") {
+        try {
+            Checkpoint ckpt;
+            ckpt.read_file(resume_filepath);
+            sim->load_checkpoint(ckpt);
+        }
+        catch (std::exception& e) {
+            print_message_and_die("could not resume: %s", e.what());
         }
+    }
 
-        auto& mt = mtr.next();
-        // ignore anything that's not a write
-        if (!mt.is_write) continue;
+    if (n_promotions_to_event_trace != 0) {
+        open_event_trace();
+        sim->set_event_trace(event_trace.get(), n_promotions_to_event_trace);
+    }
 
-        auto page_addr = line_addr_to_page_addr(mt.line_addr, line_size_log2,
-                page_size_log2);
+    if (checkpoint_interval != 0)
+        sim->set_checkpointing("snqueues-checkpoint.bin", checkpoint_interval);
 
-        // get the correct bfpw for the page
-        uint64_t page_bfpw = 0;
-        if (write_factor_mode == WF_MODE_AVERAGE) {
-            page_bfpw = average_bfpw;
-        }
-        else if (write_factor_mode == WF_MODE_PER_PAGE) {
-            auto page_bfpw_it = page_bfpws.find(page_addr);
-            page_bfpw = page_bfpw_it == page_bfpws.end() ?
-                average_bfpw : page_bfpw_it->second;
-        }
-
-
-        auto fmi = page_map.at(page_addr);
-        frame_meta_t* fm = *fmi;
-        //printf("FM ptr = %p; fm q=%zu; fm ibf=%zu; fm lbf=%zu\n",
-        //        fm, fm->queue, fm->interval_bfs, fm->lifetime_bfs);
-
-        if (fm->interval_bfs >= bucket_interval) {
-            //printf("%p hit interval; q=%zu\n", fm, fm->queue);
-            // frame has hit its write interval.
-            // 1. promote the frame into the next-higher queue
-            // 2. in the lowest active queue, "rotate" the head frame with
-            //    the tail frame
-            // 3. swap the contents of the new tail frame in the lowest
-            //    queue with the promoted frame (i.e., update page_addr in
-            //    fm and map)
-            // NOTE: we do account for extra writes incurred by swap
-
-            size_t old_queue_idx = fm->queue;
-            queues_vec[old_queue_idx].erase(fmi);
-            size_t new_queue_idx = old_queue_idx + 1;
-
-            // check to update the memoized lowest queue
-            if (queues_vec[lowest_active_queue].empty())
-                lowest_active_queue += 1;
-
-            // check if we've maxed out the queues
-            if (new_queue_idx == queues_vec.size()) {
-                // break out of the loop and exit after this
-                cont = false;
-            }
-            else {
-                queues_vec[new_queue_idx].emplace_back(fm);
-                fm->queue = new_queue_idx;
-                // subtract off the bucket interval to indicate promotion
-                fm->interval_bfs -= bucket_interval;
-                //printf("q0l: %zu; promotion to %zu; ibfs: %zu\n",
-                //        queues_vec[0].size(), fm->queue, fm->interval_bfs);
-
-                // NOTE: we only do the swap to a lower bucket (never to same)
-                if (lowest_active_queue < fm->queue) {
-
-                    // pop-and-push in the lowest active queue
-                    auto lfm = queues_vec[lowest_active_queue].front();
-                    queues_vec[lowest_active_queue].pop_front();
-                    queues_vec[lowest_active_queue].emplace_back(lfm);
-
-                    // swap page_addr in l/fm and page_map
-                    fm->page_addr = lfm->page_addr;
-                    lfm->page_addr = page_addr;
-
-                    // update page_map to reflect the now-swapped mapping. both
-                    // frames are now at the back of their respective queues.
-                    auto new_queue_back =
-                            std::next(queues_vec[new_queue_idx].end(), -1);
-                    auto lowest_queue_back =
-                            std::next(queues_vec[lowest_active_queue].end(),
-                            -1);
-
-                    page_map[fm->page_addr] = new_queue_back;
-                    page_map[lfm->page_addr] = lowest_queue_back;
-
-
-                    // apply the swap write itself to both frames
-                    // 1. look up bfpw for the lower frame
-                    uint64_t lfm_bfpw = 0;
-                    if (write_factor_mode == WF_MODE_AVERAGE) {
-                        lfm_bfpw = average_bfpw;
-                    }
-                    else if (write_factor_mode == WF_MODE_PER_PAGE) {
-                        auto lfm_bfpw_it = page_bfpws.find(lfm->page_addr);
-                        lfm_bfpw = lfm_bfpw_it == page_bfpws.end() ?
-                            average_bfpw : lfm_bfpw_it->second;
-                    }
-                    // 2. apply to both frames
-                    // NOTE: technically, our "bit flip percentages" are defined
-                    // only for successive time steps of writes of the same
-                    // page onto a frame, and undefined for "page 1" being
-                    // remapped onto a frame originally mapped by "page 0".
-                    // However, we can approximate the remap bitflip as the
-                    // *newly-mapped* page's bitflip value.
-                    fm->interval_bfs += lfm_bfpw;
-                    fm->lifetime_bfs += lfm_bfpw;
-                    lfm->interval_bfs += page_bfpw;
-                    lfm->lifetime_bfs += page_bfpw;
-
-                    ++total_n_promotions;
-
-                    // if we're within n_promotions_to_event_trace, trace
-                    // the event timestamp (cycle).
-                    if (total_n_promotions <= n_promotions_to_event_trace) {
-                        uint64_t curr_timestamp = mt.cycle +
-                                (mtr.get_n_full_passes() * trace_end_cycle);
-                        event_trace.get()->write((char*) &curr_timestamp,
-                                sizeof(curr_timestamp));
-                    }
-                }
-            }
+    if (telemetry_enabled == 1) {
+        try {
+            sim->set_telemetry("snqueues-telemetry.bin",
+                    "snqueues-wearmap.bin", telemetry_interval);
         }
-        else {
-            fm->interval_bfs += page_bfpw;
+        catch (std::exception& e) {
+            print_message_and_die("could not start telemetry: %s", e.what());
         }
+    }
+
+    sim->run();
+}
+
+
+/*
+ * Open the promotion event trace. When resuming, keep the events traced up to
+ * the checkpoint (dropping any the interrupted run wrote after it), and append
+ * to them.
+ */
+void
+SNQueues::open_event_trace()
+{
+    std::string filepath = "snqueues-promotion-timestamps-uint64.bin";
+
+    if (resume_filepath == "") {
+        event_trace = std::make_unique<std::ofstream>(filepath,
+                std::ofstream::out | std::ofstream::binary);
+        return;
+    }
+
+    uint64_t n_traced = std::min(sim->get_n_remaps(),
+            n_promotions_to_event_trace);
+    std::error_code ec;
+    if (std::filesystem::file_size(filepath, ec) < n_traced * sizeof(uint64_t)
+            or ec)
+        print_message_and_die("could not resume: %s is missing events "
+                "traced before the checkpoint", filepath.c_str());
+    std::filesystem::resize_file(filepath, n_traced * sizeof(uint64_t));
+
+    event_trace = std::make_unique<std::ofstream>(filepath,
+            std::ofstream::out | std::ofstream::binary | std::ofstream::app);
+}
+
+
+/*
+ * Simulate every configuration in the sweep file over the one shared write
+ * stream, each as its own task on a thread pool; a configuration's memory is
+ * freed as soon as it reaches end of life (or the iteration limit).
+ */
+void
+SNQueues::run_sweep()
+{
+    auto start_time = std::chrono::steady_clock::now();
+
+    ThreadPool pool;
+    printf("Beginning sweep of %zu configurations on %zu threads\n",
+            sweep_configs.size(), pool.get_n_threads());
+
+    sweep_rows.resize(sweep_configs.size());
+    pool.parallel_for(sweep_configs.size(), [this](size_t i) {
+        auto sweep_sim = make_simulation(domain_wss[0], sweep_configs[i],
+                false /* verbose */);
+        sweep_sim->run();
+        sweep_rows[i] = sweep_sim->get_summary_row();
+    });
+
+    std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_time;
+    printf("sweep time (s): %f\n", elapsed.count());
+}
+
+
+/*
+ * Simulate each domain over its own part of the write stream, with its share
+ * of the memory, each as its own task on a thread pool. The domains never
+ * interact, so each simply runs to its own end of life; the system's is then
+ * the worst domain's.
+ */
+void
+SNQueues::run_domains()
+{
+    auto start_time = std::chrono::steady_clock::now();
+
+    sim_config_t domain_config = base_config;
+    domain_config.n_bytes_requested /= n_domains;
+
+    ThreadPool pool;
+    printf("Beginning simulation of %zu domains on %zu threads\n", n_domains,
+            pool.get_n_threads());
+
+    domain_sims.resize(n_domains);
+    pool.parallel_for(n_domains, [this, &domain_config](size_t d) {
+        // (a domain that's never written never wears out)
+        if (domain_wss[d].writes.empty()) return;
+
+        domain_sims[d] = make_simulation(domain_wss[d], domain_config,
+                false /* verbose */);
+        domain_sims[d]->run();
+    });
+
+    std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_time;
+    printf("domains time (s): %f\n", elapsed.count());
+}
+
+
+/*
+ * Simulate n_trials independent draws of the frames' endurances (trial i
+ * seeded with the seed + i) over the one shared write stream, each as its own
+ * task on a thread pool. Each trial runs to its own end of life (i.e., its
+ * weakest frame's, relative to its wear).
+ */
+void
+SNQueues::run_trials()
+{
+    auto start_time = std::chrono::steady_clock::now();
+
+    ThreadPool pool;
+    printf("Beginning %zu endurance trials on %zu threads\n", n_trials,
+            pool.get_n_threads());
+
+    trial_lifetimes_s.resize(n_trials);
+    trial_rows.resize(n_trials);
+    pool.parallel_for(n_trials, [this](size_t i) {
+        sim_config_t trial_config = base_config;
+        trial_config.endurance_seed = base_config.endurance_seed + i;
+
+        auto trial_sim = make_simulation(domain_wss[0], trial_config,
+                false /* verbose */);
+        trial_sim->run();
+        trial_lifetimes_s[i] = trial_sim->get_lifetime_est_s();
+        trial_rows[i] = trial_sim->get_summary_row();
+    });
+
+    std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_time;
+    printf("trials time (s): %f\n", elapsed.count());
+}
 
 
-        //// whether we hit interval or not, increment both bfs
-        fm->lifetime_bfs += page_bfpw;
+/*
+ * Simulate the super-frame configuration and its exact, page-level
+ * equivalent (over calib_ws), timing each (including its setup). They run one
+ * after the other, so that neither's time includes contention with the other.
+ */
+void
+SNQueues::run_calibration()
+{
+    sim_config_t calib_config = base_config;
+    calib_config.page_size = page_size;
+
+    printf("Beginning calibration of %zu-page super-frames against pages\n",
+            ((uint64_t) 1) << super_frame_shift);
 
+    calib_times_s.resize(2);
+    for (size_t i = 0; i < 2; ++i) {
+        auto start_time = std::chrono::steady_clock::now();
 
-        // always check to update the most-written frame at end
-        // nullptr check: ensure we always have some valid most_written_frame
-        if (most_written_frame == nullptr or
-                fm->lifetime_bfs > most_written_frame->lifetime_bfs) {
-            most_written_frame = fm;
+        if (i == 0) {
+            sim = make_simulation(domain_wss[0], base_config,
+                    false /* verbose */);
+            sim->run();
+        }
+        else {
+            calib_sim = make_simulation(calib_ws, calib_config,
+                    false /* verbose */);
+            calib_sim->run();
         }
+
+        std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start_time;
+        calib_times_s[i] = elapsed.count();
     }
 }
 
@@ -475,92 +1456,134 @@ SNQueues::run()
 void
 SNQueues::dump_stats(bool final)
 {
-    /*
-     * NOTE: VIAMAX is calculated
-     * 1. via the most-written frame, and
-     * 2. via the full memory size used in simulation.
-     * whereas VIAAVG is calculated
-     * 1. via the average of bitflips across the memory, and
-     * 2. via the requested memory size.
-     */
-
-    // don't want to continuously calculate these, so just do it here
-    double most_written_frame_wear_pct =
-            (double) most_written_frame->lifetime_bfs / (double) bucket_cap;
-    double lifetime_est_viamax_s = (double) system_time_s /
-            (double) most_written_frame_wear_pct;
-    double lifetime_est_viamax_y = lifetime_est_viamax_s /
-            ((double) 86400 * 365);
-
-
-    // these are only calculated (and printed) upon termination
-    double lifetime_est_viaavg_s = 0.0;
-    double lifetime_est_viaavg_y = 0.0;
-    if (final) {
-        // NOTE: calculates the average for num. *requested* bytes
-        uint64_t bfs_possible = n_bytes_requested * 8 * cell_write_endurance;
-        uint64_t bfs_performed = 0;
-
-        for (auto& l : queues_vec) {
-            for (auto& f_it : l) {
-                bfs_performed += f_it->lifetime_bfs;
-            }
+    if (!domain_sims.empty()) {
+        // the worst domain is the one with the shortest lifetime
+        size_t worst_domain = n_domains;
+        for (size_t d = 0; d < n_domains; ++d) {
+            if (!domain_sims[d]) continue;
+            if (worst_domain == n_domains or
+                    domain_sims[d]->get_lifetime_est_s() <
+                    domain_sims[worst_domain]->get_lifetime_est_s())
+                worst_domain = d;
         }
 
-        double frac_bfs = (double) bfs_performed / (double) bfs_possible;
-        lifetime_est_viaavg_s = system_time_s / frac_bfs;
-        lifetime_est_viaavg_y = lifetime_est_viaavg_s /
-                ((double) (86400 * 365));
-    }
+        // one row per (written) domain...
+        std::stringstream ss;
+        ss << "DOMAINS" << " " << n_domains << std::endl;
+        ss << "WORST_DOMAIN" << " " << worst_domain << std::endl;
+        ss << "DOMAIN " << get_summary_header(base_config) << std::endl;
+        for (size_t d = 0; d < n_domains; ++d) {
+            if (!domain_sims[d]) continue;
+            ss << d << " " << domain_sims[d]->get_summary_row() << std::endl;
+        }
 
+        std::cout << ss.rdbuf()->str();
 
-    std::string status = final ? "termination" : "incremental";
-    std::cout << "-------------------- " << status << " stats print" <<
-            " --------------------" << std::endl;
+        std::ofstream ofs("snqueues-domains.txt", std::ofstream::out);
+        ofs << ss.rdbuf()->str();
 
-    // using a stringstream, dump to both file and stdout
-    std::stringstream ss;
+        // ...then the worst domain's stats, as the system's
+        domain_sims[worst_domain]->dump_stats(final);
+        return;
+    }
 
-    // if in termination mode, add some extra information about our invocation
-    if (final) {
-        ss << "QUEUES" << " " << n_buckets << std::endl;
-        ss << "CELL_WRITE_ENDURANCE" << " " << cell_write_endurance <<
+    if (!trial_rows.empty()) {
+        // the distribution of the trials' lifetimes...
+        std::vector<double> lifetimes_s = trial_lifetimes_s;
+        std::sort(lifetimes_s.begin(), lifetimes_s.end());
+        double mean = 0.0;
+        for (double l : lifetimes_s) mean += l / n_trials;
+        double var = 0.0;
+        for (double l : lifetimes_s) var += (l - mean) * (l - mean) / n_trials;
+
+        std::stringstream ss;
+        ss << "TRIALS" << " " << n_trials << std::endl;
+        ss << "ENDURANCE_DIST" << " " <<
+                get_endurance_dist_name(endurance_dist) << std::endl;
+        ss << "ENDURANCE_COV" << " " << endurance_cov << std::endl;
+        ss << "ENDURANCE_SEED" << " " << endurance_seed << std::endl;
+        ss << "LIFETIME_EST_S_MEAN" << " " << mean << std::endl;
+        ss << "LIFETIME_EST_S_STDDEV" << " " << std::sqrt(var) << std::endl;
+        ss << "LIFETIME_EST_S_MIN" << " " << lifetimes_s.front() << std::endl;
+        // (nearest-rank percentiles)
+        for (uint64_t pct : {1, 5, 25, 50, 75, 95, 99}) {
+            size_t rank = (pct * n_trials + 99) / 100;
+            ss << "LIFETIME_EST_S_P" << pct << " " <<
+                    lifetimes_s[std::max(rank, (size_t) 1) - 1] << std::endl;
+        }
+        ss << "LIFETIME_EST_S_MAX" << " " << lifetimes_s.back() << std::endl;
+        ss << "LIFETIME_EST_Y_MEAN" << " " << mean / ((double) 86400 * 365) <<
                 std::endl;
-        ss << "PAGE_SIZE_BYTES" << " " << page_size << std::endl;
-        ss << "MEMORY_BYTES_REQUESTED" << " " << n_bytes_requested << std::endl;
-        ss << "MEMORY_BYTES_INSIM" << " " << n_bytes_mem << std::endl;
-        ss << "MEMORY_PAGES_INSIM" << " " << n_pages_mem << std::endl;
-    }
-
-    ss << "FULL_PASSES" << " " << mtr.get_n_full_passes() << std::endl;
-    ss << "SYSTEM_TIME_S" << " " << system_time_s << std::endl;
-    ss << "MOST_WRITTEN_FRAME_PTR" << " " << most_written_frame << std::endl;
-    ss << "MOST_WRITTEN_FRAME_BFS" << " " << most_written_frame->lifetime_bfs
-            << std::endl;
-    ss << "MOST_WRITTEN_FRAME_WEAR_PCT" << " " << most_written_frame_wear_pct
-            << std::endl;
-    ss << "MOST_WRITTEN_FRAME_QUEUE" << " " << most_written_frame->queue
-            << std::endl;
-    ss << "LOWEST_ACTIVE_QUEUE" << " " << lowest_active_queue << std::endl;
-    ss << "TOTAL_N_PROMOTIONS" << " " << total_n_promotions << std::endl;
-    ss << "LIFETIME_EST_VIAMAX_S" << " " << lifetime_est_viamax_s << std::endl;
-    ss << "LIFETIME_EST_VIAMAX_Y" << " " << lifetime_est_viamax_y << std::endl;
-
-    if (final) {
-        ss << "LIFETIME_EST_VIAAVG_S" << " " << lifetime_est_viaavg_s
-                << std::endl;
-        ss << "LIFETIME_EST_VIAAVG_Y" << " " << lifetime_est_viaavg_y
-                << std::endl;
+
+        // ...then one row per trial
+        ss << "TRIAL SEED " << get_summary_header(base_config) << std::endl;
+        for (size_t i = 0; i < n_trials; ++i) {
+            ss << i << " " << endurance_seed + i << " " << trial_rows[i] <<
+                    std::endl;
+        }
+
+        std::cout << ss.rdbuf()->str();
+
+        std::ofstream ofs("snqueues-trials.txt", std::ofstream::out);
+        ofs << ss.rdbuf()->str();
+        return;
     }
 
+    if (sim) {
+        sim->dump_stats(final);
+        if (!calib_sim) return;
+
+        // the super-frame estimate, its bound, and the exact estimate
+        // NOTE: the bound only holds for page-level accounting of the
+        // super-frame run's own mapping; the exact run wear-levels pages, with
+        // a different mapping, so it may fall on either side of it, and
+        // CALIBRATION_EXACT_IN_BOUNDS checks whether it fell in between
+        auto& ws = domain_wss[0];
+        double super_lifetime_est_s = sim->get_lifetime_est_s();
+        double super_bound_lo_s = super_lifetime_est_s /
+                (ws.max_page_share * (double) ws.pages_per_frame);
+        double exact_lifetime_est_s = calib_sim->get_lifetime_est_s();
+
+        std::stringstream ss;
+        ss << "CALIBRATION_SUPER_FRAME_PAGES" << " " << ws.pages_per_frame <<
+                std::endl;
+        ss << "CALIBRATION_SUPER_LIFETIME_EST_S" << " " <<
+                super_lifetime_est_s << std::endl;
+        ss << "CALIBRATION_SAME_MAPPING_LO_S" << " " << super_bound_lo_s <<
+                std::endl;
+        ss << "CALIBRATION_EXACT_LIFETIME_EST_S" << " " <<
+                exact_lifetime_est_s << std::endl;
+        ss << "CALIBRATION_REL_ERROR" << " " <<
+                (super_lifetime_est_s - exact_lifetime_est_s) /
+                exact_lifetime_est_s << std::endl;
+        ss << "CALIBRATION_EXACT_IN_BOUNDS" << " " <<
+                (super_bound_lo_s <= exact_lifetime_est_s and
+                exact_lifetime_est_s <= super_lifetime_est_s) << std::endl;
+        ss << "CALIBRATION_SUPER_TIME_S" << " " << calib_times_s[0] <<
+                std::endl;
+        ss << "CALIBRATION_EXACT_TIME_S" << " " << calib_times_s[1] <<
+                std::endl;
+        ss << "CALIBRATION_SPEEDUP" << " " << calib_times_s[1] /
+                calib_times_s[0] << std::endl;
 
-    std::cout << ss.rdbuf()->str();
+        std::cout << ss.rdbuf()->str();
 
-    // if in termination mode, also dump to file
-    if (final) {
-        std::ofstream ofs("snqueues.txt", std::ofstream::out);
+        std::ofstream ofs("snqueues-calibration.txt", std::ofstream::out);
         ofs << ss.rdbuf()->str();
+        return;
     }
+
+    // sweep mode: one row per configuration, in sweep file order
+    std::stringstream ss;
+    ss << get_summary_header(base_config) << std::endl;
+    for (auto& row : sweep_rows) {
+        ss << row << std::endl;
+    }
+
+    std::cout << ss.rdbuf()->str();
+
+    std::ofstream ofs("snqueues-sweep.txt", std::ofstream::out);
+    ofs << ss.rdbuf()->str();
 }
 
 
@@ -3,14 +3,23 @@
  * 1. directory containing bittrack.{txt, bin}, and
  * 2. directory containing memtrace.bin,
  * and gives progressive lifetime estimates of how long the system will last.
+ * The trace is decoded once, into a write_stream_t, which either one
+ * Simulation of the chosen wear-leveling policy replays, or (in sweep mode)
+ * many do, in parallel. Alternatively, the memory can be split into
+ * independently wear-leveled domains (e.g., channels), each with its own
+ * write_stream_t and Simulation, run in parallel; or, the frames' endurances
+ * can be drawn from a distribution, over many parallel (Monte Carlo) trials.
+ * For very large memories, pages can be approximated as aligned groups
+ * (super-pages), wear-leveled as one in super-frames; this shrinks the
+ * per-frame state, but not the write stream, nor the time per pass.
  */
 #pragma once
 
+#include <algorithm>
 #include <cstdbool>
 #include <cstdint>
 #include <fstream>
-#include <iterator>
-#include <list>
+#include <getopt.h>
 #include <memory>
 #include <random>
 #include <string>
@@ -19,7 +28,14 @@
 #include <vector>
 
 #include "../common/defs.h"
+#include "../common/FootprintCache.h"
 #include "../common/MemTraceReader.h"
+#include "../common/ThreadPool.h"
+#include "../rrllc/Cache.h"
+#include "FrameQueues.h"
+#include "Policy.h"
+#include "Simulation.h"
+#include "WriteStream.h"
 
 
 class SNQueues {
@@ -40,16 +56,12 @@ class SNQueues {
             double page_wf;
         } bittrack_entry_t;
 
-        typedef struct frame_meta_t {
-            uint64_t interval_bfs;
-            uint64_t lifetime_bfs;
-            // (figurative) backpointer to the queue we're in
-            // (store a vector index, and not a raw pointer, so we can get the
-            // "next" queue up after this when promoting)
-            size_t queue;
-            // (figurative) backpointer to the page_addr mapped to us
+        // (AGGREGATION_MODE_SORT) one page's bfpw, as kept in the sorted
+        // table; < 2^16, as bits_per_line is
+        typedef struct __attribute__((packed)) {
             page_addr_t page_addr;
-        } frame_meta_t;
+            uint16_t bfpw;
+        } page_bfpw_t;
 
         typedef enum {
             WF_MODE_AVERAGE,
@@ -57,35 +69,109 @@ class SNQueues {
             WF_MODE_INVALID
         } write_factor_mode_t;
 
+        // (super-frame mode) one page of a super-page
+        typedef struct {
+            uint64_t bfpw;
+            // written bit flips per pass
+            uint64_t bfs;
+            bool is_written;
+        } member_page_t;
+
+        typedef enum {
+            AGGREGATION_MODE_HASH,
+            AGGREGATION_MODE_SORT,
+            AGGREGATION_MODE_INVALID
+        } aggregation_mode_t;
+
 
         void parse_and_validate_args(int argc, char* argv[]);
         void read_bittrack_files();
+        void setup_page_bfpws_hash(const std::string& bin_filepath);
+        void setup_page_bfpws_sort(const std::string& bin_filepath);
+        inline uint64_t get_page_bfpw(page_addr_t page_addr);
+
+        // (dense table slots of pages BitTrack didn't see written)
+        static constexpr uint16_t NO_PAGE_BFPW = UINT16_MAX;
+        // use a dense table if the written page addrs. span at most this many
+        // times as many slots as there are pages (i.e., it's no bigger than
+        // the sorted table would be)
+        static constexpr uint64_t MAX_DENSE_SPAN_FACTOR =
+                sizeof(page_bfpw_t) / sizeof(uint16_t);
+        // (Start-Gap's gap move period in its paper)
+        static constexpr uint64_t DEFAULT_REMAP_PERIOD = 100;
+        static constexpr uint64_t DEFAULT_N_TRIALS = 100;
+        static constexpr uint64_t DEFAULT_CONVERGE_WINDOW = 16;
+        static constexpr uint64_t MAX_SUPER_FRAME_SHIFT = 30;
+        static constexpr uint64_t DEFAULT_DRAM_CACHE_N_WAYS = 16;
+        static constexpr uint64_t DEFAULT_MIGRATION_WINDOW_CYCLES = 100000;
+        void parse_sweep_file();
+        void prepare_write_stream();
+        void record_footprint_writes(footprint_t& footprint,
+                const std::unordered_map<page_addr_t, member_page_t>&
+                member_pages);
+        void set_max_page_shares(
+                const std::unordered_map<page_addr_t, member_page_t>&
+                member_pages);
+        void run_sweep();
+        void run_domains();
+        void run_trials();
+        void run_calibration();
+        void open_event_trace();
 
 
         // input arguments
+        std::string policy_str;
+        policy_t policy;
         uint64_t n_buckets;
+        uint64_t remap_period;
         uint64_t cell_write_endurance;
         std::string memtrace_directory;
         std::string bittrack_directory;
         std::string write_factor_mode_str;
         write_factor_mode_t write_factor_mode;
+        std::string aggregation_mode_str;
+        aggregation_mode_t aggregation_mode;
         double trace_time_s;
         uint64_t n_bytes_requested;
         uint64_t n_iterations = std::numeric_limits<uint64_t>::max();
         uint64_t n_promotions_to_event_trace = 0;
+        int fast_forward_enabled;
+        std::string sweep_filepath;
+        uint64_t checkpoint_interval;
+        uint64_t n_domains;
+        int line_wear_enabled;
+        uint64_t line_rotation;
+        std::string endurance_dist_str;
+        endurance_dist_t endurance_dist;
+        double endurance_cov;
+        uint64_t n_trials;
+        uint64_t endurance_seed;
+        double converge_tol;
+        uint64_t converge_window;
+        uint64_t super_frame_shift;
+        int calibrate_enabled;
+        int footprint_cache_enabled;
+        uint64_t dram_cache_size;
+        uint64_t dram_cache_n_ways;
+        uint64_t migration_bw;
+        int migration_blocking_enabled;
+        uint64_t migration_window_cycles;
+        int telemetry_enabled;
+        uint64_t telemetry_interval;
+        std::string resume_filepath;
 
         // derived, or from input files
-        uint64_t bucket_interval;
-        uint64_t bucket_cap;
-        uint64_t n_pages_requested;
-        uint64_t n_bytes_mem;
-        uint64_t n_pages_mem;
-        uint64_t n_bytes_rss;
-        uint64_t n_pages_rss;
+        sim_config_t base_config;
+        std::vector<sim_config_t> sweep_configs;
         MemTraceReader mtr;
         std::unordered_map<std::string, std::string> bittrack_kv;
-        std::unordered_map<page_addr_t, double> page_wfs;
         std::unordered_map<page_addr_t, uint64_t> page_bfpws;
+        // AGGREGATION_MODE_SORT equivalents of page_bfpws: either a table
+        // sorted by page addr., or, if the written pages are dense enough,
+        // one slot per page addr. from dense_base_page_addr on
+        std::vector<page_bfpw_t> sorted_page_bfpws;
+        std::vector<uint16_t> dense_page_bfpws;
+        page_addr_t dense_base_page_addr = 0;
         double average_wf;
         uint64_t average_bfpw;
         uint64_t line_size;
@@ -96,15 +182,57 @@ class SNQueues {
         uint64_t bits_per_page;
 
         // internal mechanics
-        std::unordered_map<page_addr_t, std::list<frame_meta_t*>::iterator>
-                page_map;
-        std::vector<std::list<frame_meta_t*>> queues_vec;
-        uint64_t total_n_promotions = 0;
-        double system_time_s = 0.0;
-        uint64_t trace_end_cycle;
+        // by domain (just one, unless the memory is split into domains)
+        std::vector<std::unordered_map<page_addr_t, page_id_t>>
+                domain_page_ids;
+        std::vector<write_stream_t> domain_wss;
+        std::unique_ptr<Simulator> sim;
+        // (nullptr for domains that are never written)
+        std::vector<std::unique_ptr<Simulator>> domain_sims;
+        std::vector<std::string> sweep_rows;
+        std::vector<double> trial_lifetimes_s;
+        std::vector<std::string> trial_rows;
+        // (calibration only) the page-level stream and simulation, and the
+        // super-frame and page-level simulations' times
+        std::unordered_map<page_addr_t, page_id_t> calib_page_ids;
+        write_stream_t calib_ws;
+        std::unique_ptr<Simulator> calib_sim;
+        std::vector<double> calib_times_s;
         std::unique_ptr<std::ofstream> event_trace;
-
-        // memoize some things to keep some operations O(1)
-        frame_meta_t* most_written_frame = nullptr;
-        size_t lowest_active_queue = 0;
 };
+
+
+/*
+ * Inline function definitions.
+ */
+inline uint64_t
+SNQueues::get_page_bfpw(page_addr_t page_addr)
+{
+    if (write_factor_mode == WF_MODE_AVERAGE) return average_bfpw;
+
+    // otherwise, WF_MODE_PER_PAGE; fall back to the average for pages that
+    // BitTrack didn't see written
+    if (aggregation_mode == AGGREGATION_MODE_SORT) {
+        if (!dense_page_bfpws.empty()) {
+            // (unsigned, so page addrs. below the base wrap out of range)
+            uint64_t slot = page_addr - dense_base_page_addr;
+            if (slot >= dense_page_bfpws.size() or
+                    dense_page_bfpws[slot] == NO_PAGE_BFPW)
+                return average_bfpw;
+            return dense_page_bfpws[slot];
+        }
+
+        auto it = std::lower_bound(sorted_page_bfpws.begin(),
+                sorted_page_bfpws.end(), page_addr,
+                [](const page_bfpw_t& e, page_addr_t a) {
+            return e.page_addr < a;
+        });
+        if (it == sorted_page_bfpws.end() or it->page_addr != page_addr)
+            return average_bfpw;
+        return it->bfpw;
+    }
+
+    auto page_bfpw_it = page_bfpws.find(page_addr);
+    return page_bfpw_it == page_bfpws.end() ?
+        average_bfpw : page_bfpw_it->second;
+}
@@ -0,0 +1,166 @@
+#include <cstdio>
+#include <numeric>
+#include <stdexcept>
+
+#include "SecurityRefresh.h"
+
+
+SecurityRefresh::SecurityRefresh(const write_stream_t& ws,
+        const sim_config_t& cfg, uint64_t n_pages_mem) : ws(ws),
+        remap_period(cfg.remap_period), n_pages(n_pages_mem)
+{
+    frame_cap = cfg.page_size * 8 * cfg.cell_write_endurance;
+
+    frame_bfs.resize(n_pages, 0);
+    // (the first round starts from the identity mapping)
+    curr_key = get_round_key(0);
+}
+
+
+SecurityRefresh::~SecurityRefresh()
+{
+}
+
+
+uint64_t
+SecurityRefresh::get_param(const sim_config_t& cfg)
+{
+    return cfg.remap_period;
+}
+
+
+/*
+ * The new key for a round: a splitmix64 hash of the round number, cut down to
+ * a page index.
+ */
+uint64_t
+SecurityRefresh::get_round_key(uint64_t round)
+{
+    uint64_t z = (round + 1) * 0x9e3779b97f4a7c15;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    z ^= z >> 31;
+    return z & (n_pages - 1);
+}
+
+
+uint64_t
+SecurityRefresh::get_total_bfs()
+{
+    return std::accumulate(frame_bfs.begin(), frame_bfs.end(), (uint64_t) 0);
+}
+
+
+void
+SecurityRefresh::get_frame_wear(std::vector<uint64_t>& bfs)
+{
+    bfs = frame_bfs;
+}
+
+
+/*
+ * NOTE: no queues.
+ */
+void
+SecurityRefresh::get_queue_sizes(std::vector<uint64_t>& queue_sizes)
+{
+    queue_sizes.clear();
+}
+
+
+/*
+ * NOTE: not supported (see Policy.h).
+ */
+uint64_t
+SecurityRefresh::fast_forward(uint64_t, frame_idx_t&)
+{
+    return 0;
+}
+
+
+/*
+ * One refresh step, at the refresh pointer.
+ */
+void
+SecurityRefresh::refresh()
+{
+    uint64_t page = refresh_ptr;
+    uint64_t partner = page ^ prev_key ^ curr_key;
+
+    // if the partner's below the pointer, the pair was already swapped when
+    // it was refreshed; if the keys are equal, nothing moves
+    if (partner > page) {
+        // page goes from its old frame (which partner's new frame is) to
+        // its new frame (which is partner's old frame)
+        frame_bfs[page ^ curr_key] += get_page_bfpw(page);
+        frame_bfs[page ^ prev_key] += get_page_bfpw(partner);
+        ++n_refresh_swaps;
+        last_remap = {{(frame_idx_t) (page ^ curr_key),
+                (frame_idx_t) (page ^ prev_key)},
+                {get_page_bfpw(page), get_page_bfpw(partner)}};
+    }
+
+    if (++refresh_ptr == n_pages) {
+        refresh_ptr = 0;
+        prev_key = curr_key;
+        curr_key = get_round_key(++n_rounds);
+    }
+}
+
+
+void
+SecurityRefresh::print_config()
+{
+    printf("policy: security-refresh\n");
+    printf("refresh period (writes): %zu\n", remap_period);
+    printf("frame cap: %zu\n", frame_cap);
+}
+
+
+void
+SecurityRefresh::dump_config(std::stringstream& ss)
+{
+    ss << "POLICY" << " " << "security-refresh" << std::endl;
+    ss << PARAM_NAME << " " << remap_period << std::endl;
+}
+
+
+void
+SecurityRefresh::dump_stats(std::stringstream& ss, frame_idx_t)
+{
+    ss << "REFRESH_ROUNDS" << " " << n_rounds << std::endl;
+    ss << "REFRESH_PTR" << " " << refresh_ptr << std::endl;
+}
+
+
+void
+SecurityRefresh::save(Checkpoint& ckpt)
+{
+    ckpt.put(prev_key);
+    ckpt.put(curr_key);
+    ckpt.put(refresh_ptr);
+    ckpt.put(n_rounds);
+    ckpt.put(n_writes_since_refresh);
+    ckpt.put(n_refresh_swaps);
+    ckpt.put_vector(frame_bfs);
+}
+
+
+void
+SecurityRefresh::load(Checkpoint& ckpt)
+{
+    ckpt.get(prev_key);
+    ckpt.get(curr_key);
+    ckpt.get(refresh_ptr);
+    ckpt.get(n_rounds);
+    ckpt.get(n_writes_since_refresh);
+    ckpt.get(n_refresh_swaps);
+    ckpt.get_vector(frame_bfs);
+
+    if (frame_bfs.size() != n_pages or prev_key >= n_pages or
+            curr_key >= n_pages or refresh_ptr >= n_pages)
+        throw std::runtime_error("checkpoint is truncated or corrupt");
+
+    // (a shorter remap period than the saved run's)
+    if (n_writes_since_refresh >= remap_period) n_writes_since_refresh = 0;
+}
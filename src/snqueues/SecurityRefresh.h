@@ -0,0 +1,142 @@
+/*
+ * The (single-level) Security Refresh wear-leveling policy (Seong et al.,
+ * ISCA '10): each page lives in frame page XOR key, and the key is changed
+ * gradually. Within a round, a refresh pointer sweeps through the pages, one
+ * step every remap period writes; a step at page p moves it (and its partner,
+ * p XOR old key XOR new key, which goes to p's old frame) to the new key's
+ * frames, costing a write of each. Once the pointer has swept every page, the
+ * new key becomes the old one, and a new key is drawn. End of life is when a
+ * written frame reaches its endurance.
+ * NOTE: requires a power-of-two n. pages in memory (as the memory size and
+ * page size both are). The keys are drawn from a fixed-seed hash of the round
+ * number, so runs are reproducible.
+ */
+#pragma once
+
+#include <cstdbool>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include "Checkpoint.h"
+#include "FrameQueues.h"
+#include "Policy.h"
+#include "WriteStream.h"
+
+
+class SecurityRefresh {
+    public:
+        SecurityRefresh(const write_stream_t& ws, const sim_config_t& cfg,
+                uint64_t n_pages_mem);
+        SecurityRefresh(const SecurityRefresh& sr) = delete;
+        SecurityRefresh& operator=(const SecurityRefresh& sr) = delete;
+        SecurityRefresh(SecurityRefresh&& sr) = delete;
+        SecurityRefresh& operator=(SecurityRefresh&& sr) = delete;
+        ~SecurityRefresh();
+
+        inline bool write(page_id_t p, uint64_t page_bfpw, uint64_t n_writes,
+                frame_idx_t& f);
+        inline uint64_t get_lifetime_bfs(frame_idx_t f);
+        uint64_t get_total_bfs();
+        void get_frame_wear(std::vector<uint64_t>& bfs);
+        void get_queue_sizes(std::vector<uint64_t>& queue_sizes);
+        inline uint64_t get_n_remaps();
+        inline const remap_t& get_last_remap();
+        uint64_t fast_forward(uint64_t max_n_passes,
+                frame_idx_t& most_written_frame);
+
+        void print_config();
+        void dump_config(std::stringstream& ss);
+        void dump_stats(std::stringstream& ss, frame_idx_t most_written_frame);
+        void save(Checkpoint& ckpt);
+        void load(Checkpoint& ckpt);
+
+        static uint64_t get_param(const sim_config_t& cfg);
+
+        static constexpr policy_t ID = POLICY_SECURITY_REFRESH;
+        static constexpr bool CAN_FAST_FORWARD = false;
+        static constexpr const char* PARAM_NAME = "REMAP_PERIOD_WRITES";
+        static constexpr const char* N_REMAPS_NAME = "TOTAL_N_REFRESH_SWAPS";
+
+    private:
+        inline frame_idx_t get_frame(uint64_t page);
+        inline uint64_t get_page_bfpw(uint64_t page);
+        void refresh();
+        uint64_t get_round_key(uint64_t round);
+
+        const write_stream_t& ws;
+        uint64_t remap_period;
+        uint64_t frame_cap;
+        // n. pages in memory; pages >= ws.n_pages hold filler
+        uint64_t n_pages;
+
+        // internal mechanics
+        std::vector<uint64_t> frame_bfs;
+        uint64_t prev_key = 0;
+        uint64_t curr_key;
+        uint64_t refresh_ptr = 0;
+        uint64_t n_rounds = 0;
+        uint64_t n_writes_since_refresh = 0;
+        uint64_t n_refresh_swaps = 0;
+        remap_t last_remap = {{NO_FRAME, NO_FRAME}, {0, 0}};
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline frame_idx_t
+SecurityRefresh::get_frame(uint64_t page)
+{
+    // the page has been moved to the current key's frame this round iff the
+    // refresh pointer has passed it or its partner
+    uint64_t partner = page ^ prev_key ^ curr_key;
+    if (page < refresh_ptr or partner < refresh_ptr) return page ^ curr_key;
+    return page ^ prev_key;
+}
+
+
+inline uint64_t
+SecurityRefresh::get_page_bfpw(uint64_t page)
+{
+    return ws.page_bfpws[page < ws.n_pages ? page : ws.filler_page];
+}
+
+
+inline bool
+SecurityRefresh::write(page_id_t p, uint64_t page_bfpw, uint64_t n_writes,
+        frame_idx_t& f)
+{
+    f = get_frame(p);
+    frame_bfs[f] += page_bfpw;
+    bool alive = frame_bfs[f] < frame_cap;
+
+    n_writes_since_refresh += n_writes;
+    while (n_writes_since_refresh >= remap_period) {
+        n_writes_since_refresh -= remap_period;
+        refresh();
+    }
+
+    return alive;
+}
+
+
+inline uint64_t
+SecurityRefresh::get_lifetime_bfs(frame_idx_t f)
+{
+    return frame_bfs[f];
+}
+
+
+inline uint64_t
+SecurityRefresh::get_n_remaps()
+{
+    return n_refresh_swaps;
+}
+
+
+inline const remap_t&
+SecurityRefresh::get_last_remap()
+{
+    return last_remap;
+}
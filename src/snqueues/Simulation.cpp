@@ -0,0 +1,1105 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include "../common/util.h"
+#include "BucketQueues.h"
+#include "HotColdSwap.h"
+#include "SecurityRefresh.h"
+#include "Simulation.h"
+#include "StartGap.h"
+
+
+template <typename Policy>
+Simulation<Policy>::Simulation(const write_stream_t& ws,
+        const sim_config_t& cfg, bool verbose) : ws(ws), cfg(cfg),
+        verbose(verbose), n_bytes_mem(get_n_bytes_mem(ws, cfg)),
+        n_pages_mem(n_bytes_mem / cfg.page_size),
+        frame_caps(draw_frame_caps(cfg, n_pages_mem + 1)),
+        policy(ws, cfg, n_pages_mem)
+{
+    // set some derived variables
+    bits_per_page = cfg.page_size * 8;
+    frame_cap = bits_per_page * cfg.cell_write_endurance;
+
+    // (every frame, including Start-Gap's spare)
+    if (cfg.line_wear)
+        line_wear = std::make_unique<LineWear>(cfg, n_pages_mem + 1);
+    if (cfg.migration_bw != 0)
+        window_migration_bytes.resize(ws.window_first_write_idxs.size(), 0);
+
+    if (verbose) {
+        policy.print_config();
+        if (line_wear) line_wear->print_config();
+        if (n_bytes_mem != cfg.n_bytes_requested)
+            printf("Requested memory size was < trace RSS; rounding up...\n");
+    }
+}
+
+
+template <typename Policy>
+Simulation<Policy>::~Simulation()
+{
+}
+
+
+/*
+ * Size the memory. If the number of pages in the trace is higher than what
+ * the user requested, set num. pages in mem. to the power of two that
+ * is >= rss. If the user requested more pages than what is in the trace,
+ * just go with that.
+ */
+template <typename Policy>
+uint64_t
+Simulation<Policy>::get_n_bytes_mem(const write_stream_t& ws,
+        const sim_config_t& cfg)
+{
+    uint64_t n_bytes_mem;
+    uint64_t n_pages_requested = cfg.n_bytes_requested / cfg.page_size;
+    uint64_t n_pages_rss = ws.n_pages;
+    uint64_t n_bytes_rss = n_pages_rss * cfg.page_size;
+
+    if (n_pages_rss > n_pages_requested) {
+        if (__builtin_popcountll(n_bytes_rss) == 1) {
+            // perfect power of two; keep it
+            n_bytes_mem = n_bytes_rss;
+        }
+        else {
+            uint64_t n_head_bits = (sizeof(n_bytes_rss) * 8) - 1;
+            uint64_t n_bytes_rss_log2_floor =
+                    n_head_bits - __builtin_clzll(n_bytes_rss);
+            // increment by one; next-highest
+            uint64_t n_bytes_mem_log2 = n_bytes_rss_log2_floor + 1;
+            n_bytes_mem = ((uint64_t) 1) << n_bytes_mem_log2;
+        }
+    }
+    else n_bytes_mem = cfg.n_bytes_requested;
+
+    // (+1, for Start-Gap's spare frame)
+    if (n_bytes_mem / cfg.page_size + 1 >= NO_FRAME)
+        print_message_and_die("too many frames in memory (max %u)", NO_FRAME);
+
+    return n_bytes_mem;
+}
+
+
+/*
+ * Draw every frame's (including Start-Gap's spare's) endurance from
+ * cfg.endurance_dist, with mean cfg.cell_write_endurance, and return the
+ * frames' caps in bit flips; empty if the endurance is fixed. Endurances are
+ * at least 1, so the normal distribution is truncated.
+ */
+template <typename Policy>
+std::vector<uint64_t>
+Simulation<Policy>::draw_frame_caps(const sim_config_t& cfg,
+        uint64_t n_frames)
+{
+    std::vector<uint64_t> frame_caps;
+    if (cfg.endurance_dist == ENDURANCE_DIST_FIXED) return frame_caps;
+
+    double mean = (double) cfg.cell_write_endurance;
+    double stddev = cfg.endurance_cov * mean;
+    // (parameters of the underlying normal with the same mean and stddev)
+    double log_var = std::log(1.0 + cfg.endurance_cov * cfg.endurance_cov);
+    double log_mean = std::log(mean) - log_var / 2.0;
+
+    std::mt19937_64 rng(cfg.endurance_seed);
+    std::normal_distribution<double> normal(mean, stddev);
+    std::lognormal_distribution<double> lognormal(log_mean,
+            std::sqrt(log_var));
+
+    frame_caps.reserve(n_frames);
+    for (uint64_t f = 0; f < n_frames; ++f) {
+        double endurance = cfg.endurance_dist == ENDURANCE_DIST_NORMAL ?
+                normal(rng) : lognormal(rng);
+        frame_caps.emplace_back(cfg.page_size * 8 *
+                (uint64_t) std::max(std::round(endurance), 1.0));
+    }
+
+    return frame_caps;
+}
+
+
+/*
+ * Returns false iff f has reached its cap, after updating the most-worn frame
+ * (by the fraction of its own cap used; compared exactly, as cross products).
+ */
+template <typename Policy>
+inline bool
+Simulation<Policy>::check_frame_cap(frame_idx_t f)
+{
+    uint64_t bfs = policy.get_lifetime_bfs(f);
+    if (most_worn_frame == NO_FRAME or (unsigned __int128) bfs *
+            frame_caps[most_worn_frame] > (unsigned __int128)
+            policy.get_lifetime_bfs(most_worn_frame) * frame_caps[f])
+        most_worn_frame = f;
+
+    return bfs < frame_caps[f];
+}
+
+
+/*
+ * Write the cycle of each of the first n_remaps_to_event_trace remaps (i.e.,
+ * for buckets, promotions that swapped), scaled by the pass it happened in,
+ * to event_trace.
+ * NOTE: requires ws.cycles.
+ */
+template <typename Policy>
+void
+Simulation<Policy>::set_event_trace(std::ofstream* event_trace,
+        uint64_t n_remaps_to_event_trace)
+{
+    this->event_trace = event_trace;
+    this->n_remaps_to_event_trace = n_remaps_to_event_trace;
+}
+
+
+/*
+ * Every interval_n_passes passes, snapshot the full simulation state at the
+ * pass boundary, and write it to filepath in the background.
+ */
+template <typename Policy>
+void
+Simulation<Policy>::set_checkpointing(const std::string& filepath,
+        uint64_t interval_n_passes)
+{
+    checkpoint_filepath = filepath;
+    checkpoint_interval = interval_n_passes;
+    checkpoint_writer = std::make_unique<ThreadPool>(1);
+}
+
+
+/*
+ * Every interval_n_passes passes (0: as often as Telemetry's overhead budget
+ * allows), append a wear snapshot to the telemetry stream at filepath; at
+ * termination, write the per-frame wear map to wear_map_filepath. When
+ * resuming, the stream starts over from the checkpoint's pass.
+ * Throws std::runtime_error if the stream can't be opened.
+ */
+template <typename Policy>
+void
+Simulation<Policy>::set_telemetry(const std::string& filepath,
+        const std::string& wear_map_filepath, uint64_t interval_n_passes)
+{
+    policy.get_frame_wear(telemetry_frame_bfs);
+    policy.get_queue_sizes(telemetry_queue_sizes);
+    if (interval_n_passes == 0)
+        interval_n_passes = Telemetry::get_auto_interval(
+                telemetry_frame_bfs.size(), ws.writes.size());
+
+    telemetry = std::make_unique<Telemetry>(filepath, interval_n_passes,
+            telemetry_frame_bfs.size(), frame_cap,
+            telemetry_queue_sizes.size());
+    this->wear_map_filepath = wear_map_filepath;
+    last_telemetry_pass = n_full_passes;
+
+    if (verbose)
+        printf("telemetry interval (passes): %zu\n", interval_n_passes);
+}
+
+
+/*
+ * Snapshot the wear at the end of pass n_full_passes.
+ */
+template <typename Policy>
+void
+Simulation<Policy>::record_telemetry()
+{
+    policy.get_frame_wear(telemetry_frame_bfs);
+    policy.get_queue_sizes(telemetry_queue_sizes);
+    telemetry->record(n_full_passes + 1, system_time_s, policy.get_n_remaps(),
+            telemetry_frame_bfs, telemetry_queue_sizes);
+    last_telemetry_pass = n_full_passes + 1;
+}
+
+
+/*
+ * Checkpoints are only valid against the same trace (and bittrack data and
+ * write factor mode), so they carry a checksum of the write stream.
+ */
+template <typename Policy>
+uint64_t
+Simulation<Policy>::get_stream_checksum()
+{
+    if (stream_checksum != 0) return stream_checksum;
+
+    // FNV-1a over the (page, bfpw, line) triples
+    uint64_t h = 0xcbf29ce484222325;
+    for (auto& w : ws.writes) {
+        h = (h ^ w.page) * 0x100000001b3;
+        h = (h ^ w.bfpw) * 0x100000001b3;
+        h = (h ^ w.line) * 0x100000001b3;
+    }
+    stream_checksum = h | 1;  // (0 means "not yet computed")
+    return stream_checksum;
+}
+
+
+/*
+ * Serialize the full simulation state. Only valid at a pass boundary (i.e.,
+ * the next write to replay is the first of pass n_full_passes).
+ */
+template <typename Policy>
+void
+Simulation<Policy>::save_checkpoint(Checkpoint& ckpt)
+{
+    ckpt.put(Checkpoint::MAGIC);
+    ckpt.put(Checkpoint::VERSION);
+
+    // what the state is only meaningful against
+    ckpt.put((uint64_t) Policy::ID);
+    ckpt.put(n_pages_mem);
+    ckpt.put(cfg.cell_write_endurance);
+    ckpt.put(ws.n_pages);
+    ckpt.put((uint64_t) ws.writes.size());
+    ckpt.put(get_stream_checksum());
+    ckpt.put((uint64_t) cfg.line_wear);
+
+    // the state itself
+    ckpt.put(n_full_passes);
+    ckpt.put(n_fast_forwarded_passes);
+    ckpt.put(system_time_s);
+    ckpt.put(most_written_frame);
+    ckpt.put(migration_bytes);
+    ckpt.put(migration_stall_s);
+    ckpt.put(migration_time_s);
+    policy.save(ckpt);
+    if (line_wear) line_wear->save(ckpt);
+}
+
+
+/*
+ * Restore the state saved by save_checkpoint(), so that run() picks up at the
+ * start of the pass it was saved at. The endurance (and everything else not
+ * part of the frames' state, e.g., -t, -i, -f) may differ from the saved run,
+ * to fork variations off of a mid-life state; the policy, memory size,
+ * write stream and line wear mode must match (as must the policy's own
+ * state; e.g., the n. buckets). Throws std::runtime_error otherwise.
+ * NOTE: the migration totals carry over even if the migration cost model's
+ * settings differ.
+ */
+template <typename Policy>
+void
+Simulation<Policy>::load_checkpoint(Checkpoint& ckpt)
+{
+    uint64_t magic, version;
+    ckpt.get(magic);
+    ckpt.get(version);
+    if (magic != Checkpoint::MAGIC or version != Checkpoint::VERSION)
+        throw std::runtime_error("not a (current-version) SNQueues "
+                "checkpoint");
+
+    uint64_t ckpt_policy, ckpt_n_pages_mem, ckpt_cell_write_endurance;
+    uint64_t ckpt_n_pages, ckpt_n_writes, ckpt_stream_checksum;
+    uint64_t ckpt_line_wear;
+    ckpt.get(ckpt_policy);
+    ckpt.get(ckpt_n_pages_mem);
+    ckpt.get(ckpt_cell_write_endurance);
+    ckpt.get(ckpt_n_pages);
+    ckpt.get(ckpt_n_writes);
+    ckpt.get(ckpt_stream_checksum);
+    ckpt.get(ckpt_line_wear);
+
+    if (ckpt_policy != Policy::ID)
+        throw std::runtime_error("checkpoint is of a different wear-leveling "
+                "policy");
+    if (ckpt_n_pages_mem != n_pages_mem)
+        throw std::runtime_error("checkpoint has a different memory size");
+    if (ckpt_n_pages != ws.n_pages or ckpt_n_writes != ws.writes.size() or
+            ckpt_stream_checksum != get_stream_checksum())
+        throw std::runtime_error("checkpoint is of a different trace, "
+                "BitTrack data or write factor mode");
+    if (ckpt_line_wear != (uint64_t) cfg.line_wear)
+        throw std::runtime_error("checkpoint has a different line wear mode");
+
+    if (verbose and ckpt_cell_write_endurance != cfg.cell_write_endurance)
+        printf("NOTE: resuming a checkpoint with endurance %zu at endurance "
+                "%zu\n", ckpt_cell_write_endurance, cfg.cell_write_endurance);
+
+    ckpt.get(n_full_passes);
+    ckpt.get(n_fast_forwarded_passes);
+    ckpt.get(system_time_s);
+    ckpt.get(most_written_frame);
+    ckpt.get(migration_bytes);
+    ckpt.get(migration_stall_s);
+    ckpt.get(migration_time_s);
+    policy.load(ckpt);
+    if (line_wear) line_wear->load(ckpt);
+    last_checkpoint_pass = n_full_passes;
+
+    if (verbose)
+        printf("Resuming from checkpoint at pass %zu\n", n_full_passes);
+}
+
+
+/*
+ * Snapshot the state into memory, and hand it off to the writer thread, so
+ * that the main loop only stalls for the copy (and for the previous write,
+ * if that's somehow still going).
+ */
+template <typename Policy>
+void
+Simulation<Policy>::checkpoint()
+{
+    checkpoint_writer->wait();
+
+    // everything traced up to here must be on disk before the checkpoint is
+    if (event_trace != nullptr) event_trace->flush();
+
+    auto ckpt = std::make_shared<Checkpoint>();
+    save_checkpoint(*ckpt);
+    checkpoint_writer->submit([ckpt, filepath = checkpoint_filepath] {
+        try {
+            ckpt->write_file(filepath);
+        }
+        catch (std::exception& e) {
+            fprintf(stderr, "WARNING: %s\n", e.what());
+        }
+    });
+
+    last_checkpoint_pass = n_full_passes;
+}
+
+
+template <typename Policy>
+void
+Simulation<Policy>::run()
+{
+    // print some initial stats
+    if (verbose) {
+        printf("Beginning simulation\n");
+        printf("Global MiB in memory: %zu\n", n_bytes_mem / (1024 * 1024));
+    }
+
+
+    // main loop
+    bool alive = true;
+    size_t write_idx = 0;
+    uint64_t n_remaps = policy.get_n_remaps();
+    while (alive) {
+        if (write_idx == ws.writes.size()) {
+            system_time_s += cfg.trace_time_s;
+            if (cfg.migration_bw != 0) finish_migration_pass(cfg.trace_time_s);
+            if (telemetry and n_full_passes + 1 - last_telemetry_pass >=
+                    telemetry->get_interval())
+                record_telemetry();
+            if (verbose) dump_stats(/* final = false; incremental */);
+
+            if (n_full_passes + 1 == cfg.n_iterations) break;
+            if (cfg.converge_tol != 0.0 and check_convergence()) break;
+
+            ++n_full_passes;
+            write_idx = 0;
+
+            if (checkpoint_interval != 0 and
+                    n_full_passes - last_checkpoint_pass >= checkpoint_interval)
+                checkpoint();
+
+            // jump over passes the policy knows it can apply in aggregate;
+            // the jump's last pass is then finished off (time, stats,
+            // termination) at the loop top
+            if constexpr (Policy::CAN_FAST_FORWARD) {
+                uint64_t k = cfg.fast_forward ? policy.fast_forward(
+                        cfg.n_iterations - n_full_passes,
+                        most_written_frame) : 0;
+                if (k != 0) {
+                    system_time_s += (k - 1) * cfg.trace_time_s;
+                    // (no remaps, and so no migration, in those passes)
+                    migration_time_s += (k - 1) * cfg.trace_time_s;
+                    n_full_passes += k - 1;
+                    n_fast_forwarded_passes += k;
+                    write_idx = ws.writes.size();
+                    continue;
+                }
+            }
+        }
+
+        auto& w = ws.writes[write_idx++];
+        frame_idx_t f;
+        alive = policy.write(w.page, w.bfpw, ws.is_coalesced ? w.n_writes : 1,
+                f);
+        if (line_wear) alive = line_wear->write(f, w.line, w.bfpw) and alive;
+        // (with endurance variation, the policies only know the nominal
+        // endurance, so only the frames' own caps end life)
+        if (!frame_caps.empty()) alive = check_frame_cap(f);
+
+        // if we're within n_remaps_to_event_trace, trace the event timestamp
+        // (cycle)
+        if (policy.get_n_remaps() != n_remaps) {
+            if (cfg.migration_bw != 0)
+                add_migration(write_idx - 1, policy.get_n_remaps() - n_remaps);
+            n_remaps = policy.get_n_remaps();
+
+            // (the remap's page writes: line by line, and against the
+            // frames' own caps)
+            if (line_wear or !frame_caps.empty()) {
+                auto& remap = policy.get_last_remap();
+                for (size_t i = 0; i < 2; ++i) {
+                    if (remap.frames[i] == NO_FRAME) continue;
+                    if (line_wear)
+                        alive = line_wear->remap(remap.frames[i],
+                                remap.bfpws[i]) and alive;
+                    if (!frame_caps.empty())
+                        alive = check_frame_cap(remap.frames[i]) and alive;
+                }
+            }
+
+            if (n_remaps <= n_remaps_to_event_trace) {
+                uint64_t curr_timestamp = ws.cycles[write_idx - 1] +
+                        (n_full_passes * ws.trace_end_cycle);
+                event_trace->write((char*) &curr_timestamp,
+                        sizeof(curr_timestamp));
+            }
+        }
+
+
+        // always check to update the most-written frame at end
+        // NO_FRAME check: ensure we always have some valid most_written_frame
+        if (most_written_frame == NO_FRAME or policy.get_lifetime_bfs(f) >
+                policy.get_lifetime_bfs(most_written_frame)) {
+            most_written_frame = f;
+        }
+    }
+
+    // (the pass the memory died in, up to its last write)
+    if (!alive and cfg.migration_bw != 0)
+        finish_migration_pass(cfg.trace_time_s * write_idx /
+                ws.writes.size());
+
+    if (checkpoint_writer) checkpoint_writer->wait();
+}
+
+
+/*
+ * Charge n_remaps remaps (each the size of the last one) to the window the
+ * write_idx-th write of the pass falls in: each frame a remap writes is one
+ * page copy, i.e., a page read plus a page write.
+ */
+template <typename Policy>
+inline void
+Simulation<Policy>::add_migration(size_t write_idx, uint64_t n_remaps)
+{
+    auto& remap = policy.get_last_remap();
+    uint64_t n_frames = (remap.frames[0] != NO_FRAME) +
+            (remap.frames[1] != NO_FRAME);
+
+    // (the last window starting at or before write_idx)
+    auto it = std::upper_bound(ws.window_first_write_idxs.begin(),
+            ws.window_first_write_idxs.end(), write_idx);
+    window_migration_bytes[it - ws.window_first_write_idxs.begin() - 1] +=
+            n_remaps * n_frames * 2 * cfg.page_size;
+}
+
+
+/*
+ * Fold the pass's (or, at end of life, the partial pass's) migration into the
+ * totals, and account it over pass_time_s. Blocking migration stalls the
+ * system for all of its copy time. Background migration only stalls it for
+ * the copy time that doesn't fit in its windows' spare bandwidth, i.e., for
+ * what it adds to each window's traffic in excess of cfg.migration_bw (over
+ * whatever excess the trace's own traffic already has).
+ */
+template <typename Policy>
+void
+Simulation<Policy>::finish_migration_pass(double pass_time_s)
+{
+    double bw = (double) cfg.migration_bw;
+    double window_s = cfg.trace_time_s * ws.window_cycles /
+            std::max<uint64_t>(ws.trace_end_cycle, 1);
+    double window_capacity = bw * window_s;
+
+    for (size_t i = 0; i < window_migration_bytes.size(); ++i) {
+        uint64_t bytes = window_migration_bytes[i];
+        if (bytes == 0) continue;
+        window_migration_bytes[i] = 0;
+        migration_bytes += bytes;
+
+        if (cfg.migration_blocking) {
+            migration_stall_s += bytes / bw;
+        } else {
+            double trace_bytes = (double) ws.window_n_accesses[i] *
+                    cfg.line_size;
+            double trace_excess = std::max(0.0, trace_bytes -
+                    window_capacity);
+            double excess = std::max(0.0, trace_bytes + bytes -
+                    window_capacity);
+            migration_stall_s += (excess - trace_excess) / bw;
+        }
+    }
+
+    migration_time_s += pass_time_s;
+}
+
+
+/*
+ * The fraction of the memory's bandwidth the migration used, over the time
+ * simulated so far.
+ */
+template <typename Policy>
+double
+Simulation<Policy>::get_migration_bw_fraction()
+{
+    if (migration_time_s == 0.0) return 0.0;
+    return migration_bytes / (cfg.migration_bw * migration_time_s);
+}
+
+
+/*
+ * How much longer the system takes to run the time simulated so far with the
+ * migration's stalls than without.
+ */
+template <typename Policy>
+double
+Simulation<Policy>::get_migration_slowdown()
+{
+    if (migration_time_s == 0.0) return 1.0;
+    return (migration_time_s + migration_stall_s) / migration_time_s;
+}
+
+
+/*
+ * At the end of a pass, add its wear (get_wear_pct(): the share of the
+ * lifetime used up, as VIAMAX, VIALINE or VIAWORN has it) to the samples, and
+ * return whether the end of life has settled. The later half of the passes
+ * since the policy's first remap is split into two equal, non-overlapping
+ * windows, of at least cfg.converge_window passes each, and each window's
+ * samples are extrapolated to the end of life (fit_end_of_life_s()). The run
+ * stops once the two fits have been within cfg.converge_tol of their mean
+ * for the last CONVERGE_HOLD_FRACTION of those passes; their range over that
+ * time is reported as the interval. (Two windows can agree by chance where
+ * the estimate's sawtooth crosses; keeping them agreeing while the windows
+ * slide filters that out.) Passes without a (finite) estimate yet, or before
+ * the first remap (when wear grows linearly, and so every fit agrees),
+ * restart the samples.
+ * NOTE: fast-forwarded passes aren't observed, and so don't count; nor do
+ * the samples survive a checkpoint.
+ */
+template <typename Policy>
+bool
+Simulation<Policy>::check_convergence()
+{
+    double wear_pct = get_wear_pct();
+    if (wear_pct == 0.0 or policy.get_n_remaps() == 0) {
+        conv_samples.clear();
+        conv_n_passes = 0;
+        conv_agree_pass = 0;
+        return false;
+    }
+
+    ++conv_n_passes;
+    conv_samples.push_back({system_time_s, wear_pct});
+    while (conv_samples.size() > conv_n_passes / 2) conv_samples.pop_front();
+
+    size_t window_size = conv_samples.size() / 2;
+    if (window_size < cfg.converge_window) return false;
+    // (a fit takes O(window_size), so they're only redone every so many
+    // passes, to stay O(1) per pass)
+    if (conv_n_passes % std::max<size_t>(1,
+            window_size / CONVERGE_FITS_PER_WINDOW) != 0)
+        return false;
+
+    size_t first = conv_samples.size() - 2 * window_size;
+    double fit_a_s = fit_end_of_life_s(first, first + window_size);
+    double fit_b_s = fit_end_of_life_s(first + window_size,
+            conv_samples.size());
+    double lo_s = std::min(fit_a_s, fit_b_s);
+    double hi_s = std::max(fit_a_s, fit_b_s);
+    conv_fit_s = (fit_a_s + fit_b_s) / 2.0;
+
+    if (lo_s == 0.0 or hi_s - lo_s > cfg.converge_tol * conv_fit_s) {
+        conv_agree_pass = 0;
+        conv_lo_s = lo_s;
+        conv_hi_s = hi_s;
+        return false;
+    }
+
+    if (conv_agree_pass == 0) {
+        conv_agree_pass = conv_n_passes;
+        conv_lo_s = lo_s;
+        conv_hi_s = hi_s;
+    }
+    conv_lo_s = std::min(conv_lo_s, lo_s);
+    conv_hi_s = std::max(conv_hi_s, hi_s);
+
+    converged = (double) (conv_n_passes - conv_agree_pass) >=
+            CONVERGE_HOLD_FRACTION * (double) conv_n_passes;
+    return converged;
+}
+
+
+/*
+ * Extrapolate the samples [first, last) to the end of life: fit
+ *     wear = a + b * system time
+ * by least squares, raise the line to the samples' upper envelope (the
+ * largest residual), and return the system time it reaches 1 at (not before
+ * the window's end), or 0 if the wear isn't growing. The envelope, not the
+ * fit, is what matters: the most-written frame's wear grows in steps, as hot
+ * pages are remapped onto it, and the end of life comes at a step.
+ */
+template <typename Policy>
+double
+Simulation<Policy>::fit_end_of_life_s(size_t first, size_t last)
+{
+    // (wear is taken relative to the first sample's, so that a window
+    // without any growth fits to a slope of exactly 0)
+    double n = (double) (last - first);
+    double wear_pct_0 = conv_samples[first].wear_pct;
+    double t_mean = 0.0, dwear_mean = 0.0;
+    for (size_t i = first; i < last; ++i) {
+        t_mean += conv_samples[i].system_time_s / n;
+        dwear_mean += (conv_samples[i].wear_pct - wear_pct_0) / n;
+    }
+
+    double stt = 0.0, stw = 0.0;
+    for (size_t i = first; i < last; ++i) {
+        double dt = conv_samples[i].system_time_s - t_mean;
+        stt += dt * dt;
+        stw += dt * (conv_samples[i].wear_pct - wear_pct_0);
+    }
+    if (stt == 0.0 or stw <= 0.0) return 0.0;
+
+    double b = stw / stt;
+    double a = wear_pct_0 + dwear_mean - b * t_mean;
+    double max_residual = 0.0;
+    for (size_t i = first; i < last; ++i) {
+        max_residual = std::max(max_residual, conv_samples[i].wear_pct -
+                (a + b * conv_samples[i].system_time_s));
+    }
+
+    return std::max((1.0 - a - max_residual) / b,
+            conv_samples[last - 1].system_time_s);
+}
+
+
+template <typename Policy>
+uint64_t
+Simulation<Policy>::get_n_remaps()
+{
+    return policy.get_n_remaps();
+}
+
+
+/*
+ * NOTE: VIAMAX is calculated
+ * 1. via the most-written frame, and
+ * 2. via the full memory size used in simulation.
+ * whereas VIAAVG is calculated
+ * 1. via the average of bitflips across the memory, and
+ * 2. via the requested memory size.
+ */
+template <typename Policy>
+double
+Simulation<Policy>::get_lifetime_est_viamax_s()
+{
+    double most_written_frame_wear_pct =
+            (double) policy.get_lifetime_bfs(most_written_frame) /
+            (double) frame_cap;
+    return (double) system_time_s / (double) most_written_frame_wear_pct;
+}
+
+
+/*
+ * The lifetime estimate the system's end of life is judged by: via the
+ * most-written line if tracking line wear, via the most-worn frame if frames'
+ * endurances vary, else via the most-written frame.
+ */
+template <typename Policy>
+double
+Simulation<Policy>::get_lifetime_est_s()
+{
+    return system_time_s / get_wear_pct();
+}
+
+
+/*
+ * The share of its endurance used up by the line or frame that
+ * get_lifetime_est_s() goes by.
+ */
+template <typename Policy>
+double
+Simulation<Policy>::get_wear_pct()
+{
+    if (line_wear) return line_wear->get_most_written_line_wear_pct();
+    if (!frame_caps.empty()) {
+        return (double) policy.get_lifetime_bfs(most_worn_frame) /
+                (double) frame_caps[most_worn_frame];
+    }
+    return (double) policy.get_lifetime_bfs(most_written_frame) /
+            (double) frame_cap;
+}
+
+
+/*
+ * NOTE: VIALINE is calculated like VIAMAX, but via the most-written line.
+ */
+template <typename Policy>
+double
+Simulation<Policy>::get_lifetime_est_vialine_s()
+{
+    return system_time_s / line_wear->get_most_written_line_wear_pct();
+}
+
+
+/*
+ * NOTE: VIAWORN is calculated like VIAMAX, but via the frame that's used the
+ * most of its own cap (i.e., not necessarily the most-written one).
+ */
+template <typename Policy>
+double
+Simulation<Policy>::get_lifetime_est_viaworn_s()
+{
+    double most_worn_frame_wear_pct =
+            (double) policy.get_lifetime_bfs(most_worn_frame) /
+            (double) frame_caps[most_worn_frame];
+    return system_time_s / most_worn_frame_wear_pct;
+}
+
+
+template <typename Policy>
+double
+Simulation<Policy>::get_lifetime_est_viaavg_s()
+{
+    // NOTE: calculates the average for num. *requested* bytes
+    uint64_t bfs_possible = cfg.n_bytes_requested * 8 *
+            cfg.cell_write_endurance;
+    uint64_t bfs_performed = policy.get_total_bfs();
+
+    double frac_bfs = (double) bfs_performed / (double) bfs_possible;
+    return system_time_s / frac_bfs;
+}
+
+
+template <typename Policy>
+void
+Simulation<Policy>::dump_stats(bool final)
+{
+    // don't want to continuously calculate these, so just do it here
+    uint64_t most_written_frame_bfs =
+            policy.get_lifetime_bfs(most_written_frame);
+    double most_written_frame_wear_pct =
+            (double) most_written_frame_bfs / (double) frame_cap;
+    double lifetime_est_viamax_s = get_lifetime_est_viamax_s();
+    double lifetime_est_viamax_y = lifetime_est_viamax_s /
+            ((double) 86400 * 365);
+
+
+    // these are only calculated (and printed) upon termination
+    double lifetime_est_viaavg_s = 0.0;
+    double lifetime_est_viaavg_y = 0.0;
+    if (final) {
+        lifetime_est_viaavg_s = get_lifetime_est_viaavg_s();
+        lifetime_est_viaavg_y = lifetime_est_viaavg_s /
+                ((double) (86400 * 365));
+    }
+
+
+    std::string status = final ? "termination" : "incremental";
+    std::cout << "-------------------- " << status << " stats print" <<
+            " --------------------" << std::endl;
+
+    // using a stringstream, dump to both file and stdout
+    std::stringstream ss;
+
+    // if in termination mode, add some extra information about our invocation
+    if (final) {
+        policy.dump_config(ss);
+        ss << "CELL_WRITE_ENDURANCE" << " " << cfg.cell_write_endurance <<
+                std::endl;
+        ss << "PAGE_SIZE_BYTES" << " " << cfg.page_size << std::endl;
+        if (line_wear) {
+            ss << "LINE_SIZE_BYTES" << " " << cfg.line_size << std::endl;
+            line_wear->dump_config(ss);
+        }
+        if (!frame_caps.empty()) {
+            ss << "ENDURANCE_DIST" << " " <<
+                    get_endurance_dist_name(cfg.endurance_dist) << std::endl;
+            ss << "ENDURANCE_COV" << " " << cfg.endurance_cov << std::endl;
+            ss << "ENDURANCE_SEED" << " " << cfg.endurance_seed << std::endl;
+        }
+        ss << "MEMORY_BYTES_REQUESTED" << " " << cfg.n_bytes_requested <<
+                std::endl;
+        ss << "MEMORY_BYTES_INSIM" << " " << n_bytes_mem << std::endl;
+        ss << "MEMORY_PAGES_INSIM" << " " << n_pages_mem << std::endl;
+        if (ws.dram_cache_size != 0) {
+            ss << "DRAM_CACHE_BYTES" << " " << ws.dram_cache_size <<
+                    std::endl;
+            ss << "DRAM_CACHE_TRACE_WRITES" << " " << ws.n_trace_writes <<
+                    std::endl;
+            ss << "DRAM_CACHE_MEMORY_WRITES" << " " << ws.n_writes <<
+                    std::endl;
+            ss << "DRAM_CACHE_FLUSH_WRITES" << " " << ws.n_flush_writes <<
+                    std::endl;
+        }
+        if (cfg.migration_bw != 0) {
+            ss << "MIGRATION_BW_BYTES_S" << " " << cfg.migration_bw <<
+                    std::endl;
+            ss << "MIGRATION_MODE" << " " << (cfg.migration_blocking ?
+                    "blocking" : "background") << std::endl;
+            ss << "MIGRATION_WINDOW_CYCLES" << " " << ws.window_cycles <<
+                    std::endl;
+        }
+    }
+
+    ss << "FULL_PASSES" << " " << n_full_passes << std::endl;
+    ss << "SYSTEM_TIME_S" << " " << system_time_s << std::endl;
+    ss << "MOST_WRITTEN_FRAME_IDX" << " " << most_written_frame << std::endl;
+    ss << "MOST_WRITTEN_FRAME_BFS" << " " << most_written_frame_bfs <<
+            std::endl;
+    ss << "MOST_WRITTEN_FRAME_WEAR_PCT" << " " << most_written_frame_wear_pct
+            << std::endl;
+    policy.dump_stats(ss, most_written_frame);
+    ss << Policy::N_REMAPS_NAME << " " << policy.get_n_remaps() << std::endl;
+    ss << "LIFETIME_EST_VIAMAX_S" << " " << lifetime_est_viamax_s << std::endl;
+    ss << "LIFETIME_EST_VIAMAX_Y" << " " << lifetime_est_viamax_y << std::endl;
+
+    if (line_wear) {
+        double lifetime_est_vialine_s = get_lifetime_est_vialine_s();
+        line_wear->dump_stats(ss);
+        ss << "LIFETIME_EST_VIALINE_S" << " " << lifetime_est_vialine_s <<
+                std::endl;
+        ss << "LIFETIME_EST_VIALINE_Y" << " " << lifetime_est_vialine_s /
+                ((double) 86400 * 365) << std::endl;
+    }
+
+    if (ws.pages_per_frame > 1) {
+        // (see write_stream_t)
+        ss << "SUPER_FRAME_PAGES" << " " << ws.pages_per_frame << std::endl;
+        ss << "SUPER_FRAME_MAX_PAGE_SHARE" << " " << ws.max_page_share <<
+                std::endl;
+        ss << "LIFETIME_EST_SAME_MAPPING_LO_S" << " " << get_lifetime_est_s() /
+                (ws.max_page_share * (double) ws.pages_per_frame) <<
+                std::endl;
+    }
+
+    if (!frame_caps.empty()) {
+        double lifetime_est_viaworn_s = get_lifetime_est_viaworn_s();
+        ss << "MOST_WORN_FRAME_IDX" << " " << most_worn_frame << std::endl;
+        ss << "MOST_WORN_FRAME_WEAR_PCT" << " " <<
+                (double) policy.get_lifetime_bfs(most_worn_frame) /
+                (double) frame_caps[most_worn_frame] << std::endl;
+        ss << "LIFETIME_EST_VIAWORN_S" << " " << lifetime_est_viaworn_s <<
+                std::endl;
+        ss << "LIFETIME_EST_VIAWORN_Y" << " " << lifetime_est_viaworn_s /
+                ((double) 86400 * 365) << std::endl;
+    }
+
+    if (cfg.migration_bw != 0) {
+        ss << "MIGRATION_BYTES" << " " << migration_bytes << std::endl;
+        ss << "MIGRATION_BW_FRACTION" << " " << get_migration_bw_fraction() <<
+                std::endl;
+        ss << "MIGRATION_STALL_S" << " " << migration_stall_s << std::endl;
+        ss << "MIGRATION_SLOWDOWN" << " " << get_migration_slowdown() <<
+                std::endl;
+    }
+
+    if (final) {
+        ss << "LIFETIME_EST_VIAAVG_S" << " " << lifetime_est_viaavg_s
+                << std::endl;
+        ss << "LIFETIME_EST_VIAAVG_Y" << " " << lifetime_est_viaavg_y
+                << std::endl;
+
+        if (cfg.fast_forward)
+            ss << "FAST_FORWARDED_PASSES" << " " << n_fast_forwarded_passes
+                    << std::endl;
+
+        if (cfg.converge_tol != 0.0) {
+            ss << "CONVERGE_TOL" << " " << cfg.converge_tol << std::endl;
+            ss << "CONVERGE_WINDOW_PASSES" << " " << cfg.converge_window <<
+                    std::endl;
+            ss << "CONVERGED" << " " << converged << std::endl;
+            ss << "LIFETIME_EST_CONV_S" << " " << conv_fit_s << std::endl;
+            ss << "LIFETIME_EST_CONV_Y" << " " << conv_fit_s /
+                    ((double) 86400 * 365) << std::endl;
+            ss << "LIFETIME_EST_CONV_S_LO" << " " << conv_lo_s << std::endl;
+            ss << "LIFETIME_EST_CONV_S_HI" << " " << conv_hi_s << std::endl;
+        }
+    }
+
+
+    std::cout << ss.rdbuf()->str();
+
+    // if in termination mode, also dump to file (and the wear map)
+    if (final) {
+        std::ofstream ofs("snqueues.txt", std::ofstream::out);
+        ofs << ss.rdbuf()->str();
+
+        if (telemetry) {
+            policy.get_frame_wear(telemetry_frame_bfs);
+            Telemetry::write_wear_map(wear_map_filepath, telemetry_frame_bfs,
+                    frame_cap);
+        }
+    }
+}
+
+
+/*
+ * Column names for get_summary_row(), space-separated.
+ */
+template <typename Policy>
+std::string
+Simulation<Policy>::get_summary_header(const sim_config_t& cfg)
+{
+    std::stringstream ss;
+    ss << Policy::PARAM_NAME << " CELL_WRITE_ENDURANCE "
+            "MEMORY_BYTES_REQUESTED MEMORY_BYTES_INSIM FULL_PASSES "
+            "SYSTEM_TIME_S MOST_WRITTEN_FRAME_BFS " << Policy::N_REMAPS_NAME <<
+            " LIFETIME_EST_VIAMAX_S LIFETIME_EST_VIAMAX_Y "
+            "LIFETIME_EST_VIAAVG_S LIFETIME_EST_VIAAVG_Y";
+    if (cfg.line_wear)
+        ss << " MOST_WRITTEN_LINE_BFS LIFETIME_EST_VIALINE_S "
+                "LIFETIME_EST_VIALINE_Y";
+    if (cfg.endurance_dist != ENDURANCE_DIST_FIXED)
+        ss << " MOST_WORN_FRAME_WEAR_PCT LIFETIME_EST_VIAWORN_S "
+                "LIFETIME_EST_VIAWORN_Y";
+    if (cfg.converge_tol != 0.0)
+        ss << " CONVERGED LIFETIME_EST_CONV_S LIFETIME_EST_CONV_S_LO "
+                "LIFETIME_EST_CONV_S_HI";
+    if (cfg.migration_bw != 0)
+        ss << " MIGRATION_BW_FRACTION MIGRATION_SLOWDOWN";
+    return ss.str();
+}
+
+
+/*
+ * The termination stats, as one space-separated row (e.g., of a sweep).
+ */
+template <typename Policy>
+std::string
+Simulation<Policy>::get_summary_row()
+{
+    double lifetime_est_viamax_s = get_lifetime_est_viamax_s();
+    double lifetime_est_viaavg_s = get_lifetime_est_viaavg_s();
+
+    std::stringstream ss;
+    ss << Policy::get_param(cfg) << " " << cfg.cell_write_endurance << " " <<
+            cfg.n_bytes_requested << " " << n_bytes_mem << " " <<
+            n_full_passes << " " << system_time_s << " " <<
+            policy.get_lifetime_bfs(most_written_frame) << " " <<
+            policy.get_n_remaps() << " " << lifetime_est_viamax_s << " " <<
+            lifetime_est_viamax_s / ((double) 86400 * 365) << " " <<
+            lifetime_est_viaavg_s << " " <<
+            lifetime_est_viaavg_s / ((double) (86400 * 365));
+    if (line_wear) {
+        double lifetime_est_vialine_s = get_lifetime_est_vialine_s();
+        ss << " " << line_wear->get_most_written_line_bfs() << " " <<
+                lifetime_est_vialine_s << " " <<
+                lifetime_est_vialine_s / ((double) 86400 * 365);
+    }
+    if (!frame_caps.empty()) {
+        double lifetime_est_viaworn_s = get_lifetime_est_viaworn_s();
+        ss << " " << (double) policy.get_lifetime_bfs(most_worn_frame) /
+                (double) frame_caps[most_worn_frame] << " " <<
+                lifetime_est_viaworn_s << " " <<
+                lifetime_est_viaworn_s / ((double) 86400 * 365);
+    }
+    if (cfg.converge_tol != 0.0) {
+        ss << " " << converged << " " << conv_fit_s << " " << conv_lo_s <<
+                " " << conv_hi_s;
+    }
+    if (cfg.migration_bw != 0) {
+        ss << " " << get_migration_bw_fraction() << " " <<
+                get_migration_slowdown();
+    }
+    return ss.str();
+}
+
+
+/*
+ * Simulate cfg.policy; the only place the policies are instantiated.
+ */
+std::unique_ptr<Simulator>
+make_simulation(const write_stream_t& ws, const sim_config_t& cfg,
+        bool verbose)
+{
+    switch (cfg.policy) {
+        case POLICY_BUCKETS:
+            return std::make_unique<Simulation<BucketQueues>>(ws, cfg,
+                    verbose);
+        case POLICY_START_GAP:
+            return std::make_unique<Simulation<StartGap>>(ws, cfg, verbose);
+        case POLICY_SECURITY_REFRESH:
+            return std::make_unique<Simulation<SecurityRefresh>>(ws, cfg,
+                    verbose);
+        case POLICY_HOT_COLD_SWAP:
+            return std::make_unique<Simulation<HotColdSwap>>(ws, cfg,
+                    verbose);
+        default:
+            print_message_and_die("invalid wear-leveling policy");
+    }
+
+    return nullptr;
+}
+
+
+std::string
+get_summary_header(const sim_config_t& cfg)
+{
+    switch (cfg.policy) {
+        case POLICY_BUCKETS:
+            return Simulation<BucketQueues>::get_summary_header(cfg);
+        case POLICY_START_GAP:
+            return Simulation<StartGap>::get_summary_header(cfg);
+        case POLICY_SECURITY_REFRESH:
+            return Simulation<SecurityRefresh>::get_summary_header(cfg);
+        case POLICY_HOT_COLD_SWAP:
+            return Simulation<HotColdSwap>::get_summary_header(cfg);
+        default:
+            print_message_and_die("invalid wear-leveling policy");
+    }
+
+    return "";
+}
+
+
+/*
+ * buckets, start-gap, security-refresh and hot-cold, case-insensitively, and
+ * ignoring '-' and '_' (so startgap, start_gap, etc. all match).
+ */
+policy_t
+parse_policy(std::string policy_str)
+{
+    std::transform(policy_str.begin(), policy_str.end(), policy_str.begin(),
+            ::tolower);
+    policy_str.erase(std::remove_if(policy_str.begin(), policy_str.end(),
+            [](char c) { return c == '-' or c == '_'; }), policy_str.end());
+
+    if (policy_str == "buckets" or policy_str == "queues")
+        return POLICY_BUCKETS;
+    if (policy_str == "startgap") return POLICY_START_GAP;
+    if (policy_str == "securityrefresh") return POLICY_SECURITY_REFRESH;
+    if (policy_str == "hotcold" or policy_str == "hotcoldswap")
+        return POLICY_HOT_COLD_SWAP;
+    return POLICY_INVALID;
+}
+
+
+/*
+ * normal or lognormal, case-insensitively.
+ */
+endurance_dist_t
+parse_endurance_dist(std::string endurance_dist_str)
+{
+    std::transform(endurance_dist_str.begin(), endurance_dist_str.end(),
+            endurance_dist_str.begin(), ::tolower);
+
+    if (endurance_dist_str == "normal") return ENDURANCE_DIST_NORMAL;
+    if (endurance_dist_str == "lognormal" or endurance_dist_str == "log-normal")
+        return ENDURANCE_DIST_LOGNORMAL;
+    return ENDURANCE_DIST_INVALID;
+}
+
+
+const char*
+get_endurance_dist_name(endurance_dist_t endurance_dist)
+{
+    switch (endurance_dist) {
+        case ENDURANCE_DIST_FIXED: return "fixed";
+        case ENDURANCE_DIST_NORMAL: return "normal";
+        case ENDURANCE_DIST_LOGNORMAL: return "lognormal";
+        default: return "invalid";
+    }
+}
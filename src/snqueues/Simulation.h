@@ -0,0 +1,180 @@
+/*
+ * One SNQueues wear-leveling simulation: replays a shared, pre-decoded
+ * write_stream_t pass after pass through a wear-leveling policy (see
+ * Policy.h) until the policy reports end of life (or the iteration limit is
+ * hit), and estimates the lifetime from the resulting wear. Memory sizing,
+ * the replay loop, promotion/remap event tracing, checkpointing, wear
+ * telemetry (see Telemetry.h) and lifetime reporting are shared by all
+ * policies, as are (optional) line-granularity wear (see LineWear.h),
+ * per-frame endurance variation, and the migration cost model (the bandwidth
+ * remaps' page copies take, and the stall they cause).
+ * Simulator is the policy-agnostic handle to a Simulation<Policy>; only these
+ * coarse-grained calls are virtual, never anything per write.
+ */
+#pragma once
+
+#include <cstdbool>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../common/ThreadPool.h"
+#include "Checkpoint.h"
+#include "FrameQueues.h"
+#include "LineWear.h"
+#include "Policy.h"
+#include "Telemetry.h"
+#include "WriteStream.h"
+
+
+class Simulator {
+    public:
+        virtual ~Simulator() = default;
+
+        virtual void set_event_trace(std::ofstream* event_trace,
+                uint64_t n_remaps_to_event_trace) = 0;
+        virtual void set_checkpointing(const std::string& filepath,
+                uint64_t interval_n_passes) = 0;
+        virtual void set_telemetry(const std::string& filepath,
+                const std::string& wear_map_filepath,
+                uint64_t interval_n_passes) = 0;
+        virtual void save_checkpoint(Checkpoint& ckpt) = 0;
+        virtual void load_checkpoint(Checkpoint& ckpt) = 0;
+        virtual void run() = 0;
+        virtual void dump_stats(bool final = false) = 0;
+        virtual uint64_t get_n_remaps() = 0;
+        virtual double get_lifetime_est_s() = 0;
+        virtual std::string get_summary_row() = 0;
+};
+
+
+std::unique_ptr<Simulator> make_simulation(const write_stream_t& ws,
+        const sim_config_t& cfg, bool verbose = true);
+std::string get_summary_header(const sim_config_t& cfg);
+policy_t parse_policy(std::string policy_str);
+endurance_dist_t parse_endurance_dist(std::string endurance_dist_str);
+const char* get_endurance_dist_name(endurance_dist_t endurance_dist);
+
+
+template <typename Policy>
+class Simulation final : public Simulator {
+    public:
+        Simulation(const write_stream_t& ws, const sim_config_t& cfg,
+                bool verbose = true);
+        Simulation(const Simulation& sim) = delete;
+        Simulation& operator=(const Simulation& sim) = delete;
+        Simulation(Simulation&& sim) = delete;
+        Simulation& operator=(Simulation&& sim) = delete;
+        ~Simulation();
+
+        void set_event_trace(std::ofstream* event_trace,
+                uint64_t n_remaps_to_event_trace) override;
+        void set_checkpointing(const std::string& filepath,
+                uint64_t interval_n_passes) override;
+        void set_telemetry(const std::string& filepath,
+                const std::string& wear_map_filepath,
+                uint64_t interval_n_passes) override;
+        void save_checkpoint(Checkpoint& ckpt) override;
+        void load_checkpoint(Checkpoint& ckpt) override;
+        void run() override;
+        void dump_stats(bool final = false) override;
+        uint64_t get_n_remaps() override;
+        double get_lifetime_est_s() override;
+        std::string get_summary_row() override;
+
+        static std::string get_summary_header(const sim_config_t& cfg);
+
+    private:
+        // one pass's wear (see get_wear_pct()), for convergence
+        typedef struct {
+            double system_time_s;
+            double wear_pct;
+        } conv_sample_t;
+
+        // the share of the passes since the first remap that the end-of-life
+        // fits must keep agreeing over before the run stops
+        static constexpr double CONVERGE_HOLD_FRACTION = 0.1;
+        // (and how often they're redone, per window length)
+        static constexpr uint64_t CONVERGE_FITS_PER_WINDOW = 64;
+
+        static uint64_t get_n_bytes_mem(const write_stream_t& ws,
+                const sim_config_t& cfg);
+        static std::vector<uint64_t> draw_frame_caps(const sim_config_t& cfg,
+                uint64_t n_frames);
+        inline bool check_frame_cap(frame_idx_t f);
+        inline void add_migration(size_t write_idx, uint64_t n_remaps);
+        void finish_migration_pass(double pass_time_s);
+        double get_migration_bw_fraction();
+        double get_migration_slowdown();
+        bool check_convergence();
+        double fit_end_of_life_s(size_t first, size_t last);
+        void checkpoint();
+        void record_telemetry();
+        uint64_t get_stream_checksum();
+        double get_lifetime_est_viamax_s();
+        double get_lifetime_est_viaavg_s();
+        double get_lifetime_est_vialine_s();
+        double get_lifetime_est_viaworn_s();
+        double get_wear_pct();
+
+        const write_stream_t& ws;
+        sim_config_t cfg;
+        bool verbose;
+
+        // derived
+        uint64_t bits_per_page;
+        uint64_t frame_cap;
+        uint64_t n_bytes_mem;
+        uint64_t n_pages_mem;
+        // by frame, in bit flips (only with endurance variation; else empty)
+        std::vector<uint64_t> frame_caps;
+
+        // internal mechanics
+        Policy policy;
+        // (only if cfg.line_wear)
+        std::unique_ptr<LineWear> line_wear;
+        uint64_t n_full_passes = 0;
+        uint64_t n_fast_forwarded_passes = 0;
+        double system_time_s = 0.0;
+        std::ofstream* event_trace = nullptr;
+        uint64_t n_remaps_to_event_trace = 0;
+        std::string checkpoint_filepath;
+        uint64_t checkpoint_interval = 0;
+        uint64_t last_checkpoint_pass = 0;
+        // (one worker, so that at most one checkpoint write is in flight)
+        std::unique_ptr<ThreadPool> checkpoint_writer;
+        uint64_t stream_checksum = 0;
+        // (only with telemetry) the stream, where the final wear map goes,
+        // and scratch space for the snapshots
+        std::unique_ptr<Telemetry> telemetry;
+        std::string wear_map_filepath;
+        uint64_t last_telemetry_pass = 0;
+        std::vector<uint64_t> telemetry_frame_bfs;
+        std::vector<uint64_t> telemetry_queue_sizes;
+        // (the later half of the passes observed since the first remap; the
+        // pass their end-of-life fits started agreeing at, 0 if they don't;
+        // the fits' latest mean, and their range since they agree)
+        std::deque<conv_sample_t> conv_samples;
+        uint64_t conv_n_passes = 0;
+        uint64_t conv_agree_pass = 0;
+        double conv_fit_s = 0.0;
+        double conv_lo_s = 0.0;
+        double conv_hi_s = 0.0;
+        bool converged = false;
+        // (only with the migration cost model) by window, the current pass's
+        // page copy bytes; and, over the run, the bytes copied, the stall
+        // they caused, and the system time they're accounted over
+        std::vector<uint64_t> window_migration_bytes;
+        uint64_t migration_bytes = 0;
+        double migration_stall_s = 0.0;
+        double migration_time_s = 0.0;
+
+        // memoize to keep the per-write check O(1)
+        frame_idx_t most_written_frame = NO_FRAME;
+        // (relative to its own cap; only with endurance variation)
+        frame_idx_t most_worn_frame = NO_FRAME;
+};
@@ -0,0 +1,153 @@
+#include <cstdio>
+#include <numeric>
+#include <stdexcept>
+
+#include "StartGap.h"
+
+
+StartGap::StartGap(const write_stream_t& ws, const sim_config_t& cfg,
+        uint64_t n_pages_mem) : ws(ws), remap_period(cfg.remap_period),
+        n_pages(n_pages_mem)
+{
+    frame_cap = cfg.page_size * 8 * cfg.cell_write_endurance;
+
+    // (the extra frame starts out as the gap)
+    frame_bfs.resize(n_pages + 1, 0);
+    gap = n_pages;
+}
+
+
+StartGap::~StartGap()
+{
+}
+
+
+uint64_t
+StartGap::get_param(const sim_config_t& cfg)
+{
+    return cfg.remap_period;
+}
+
+
+uint64_t
+StartGap::get_total_bfs()
+{
+    return std::accumulate(frame_bfs.begin(), frame_bfs.end(), (uint64_t) 0);
+}
+
+
+void
+StartGap::get_frame_wear(std::vector<uint64_t>& bfs)
+{
+    bfs = frame_bfs;
+}
+
+
+/*
+ * NOTE: no queues.
+ */
+void
+StartGap::get_queue_sizes(std::vector<uint64_t>& queue_sizes)
+{
+    queue_sizes.clear();
+}
+
+
+/*
+ * NOTE: not supported (see Policy.h).
+ */
+uint64_t
+StartGap::fast_forward(uint64_t, frame_idx_t&)
+{
+    return 0;
+}
+
+
+/*
+ * Move the page below the gap into it, applying the move's write to the
+ * gap's frame.
+ */
+void
+StartGap::move_gap()
+{
+    // find the frame to move from, and the frame to move to...
+    uint64_t src, dst;
+    if (gap == 0) {
+        src = n_pages;
+        dst = 0;
+    }
+    else {
+        src = gap - 1;
+        dst = gap;
+    }
+
+    // ...and, inverting the mapping, which page is in the source frame
+    uint64_t rotated = src > gap ? src - 1 : src;
+    uint64_t page = rotated >= start ? rotated - start :
+            rotated + n_pages - start;
+    page_id_t page_id = page < ws.n_pages ? page : ws.filler_page;
+    frame_bfs[dst] += ws.page_bfpws[page_id];
+    last_remap = {{(frame_idx_t) dst, NO_FRAME}, {ws.page_bfpws[page_id], 0}};
+
+    // now, update the registers
+    if (gap == 0) {
+        gap = n_pages;
+        start = start + 1 == n_pages ? 0 : start + 1;
+    }
+    else --gap;
+
+    ++n_gap_moves;
+}
+
+
+void
+StartGap::print_config()
+{
+    printf("policy: start-gap\n");
+    printf("gap move period (writes): %zu\n", remap_period);
+    printf("frame cap: %zu\n", frame_cap);
+}
+
+
+void
+StartGap::dump_config(std::stringstream& ss)
+{
+    ss << "POLICY" << " " << "start-gap" << std::endl;
+    ss << PARAM_NAME << " " << remap_period << std::endl;
+}
+
+
+void
+StartGap::dump_stats(std::stringstream& ss, frame_idx_t)
+{
+    ss << "START" << " " << start << std::endl;
+    ss << "GAP" << " " << gap << std::endl;
+}
+
+
+void
+StartGap::save(Checkpoint& ckpt)
+{
+    ckpt.put(start);
+    ckpt.put(gap);
+    ckpt.put(n_writes_since_move);
+    ckpt.put(n_gap_moves);
+    ckpt.put_vector(frame_bfs);
+}
+
+
+void
+StartGap::load(Checkpoint& ckpt)
+{
+    ckpt.get(start);
+    ckpt.get(gap);
+    ckpt.get(n_writes_since_move);
+    ckpt.get(n_gap_moves);
+    ckpt.get_vector(frame_bfs);
+
+    if (frame_bfs.size() != n_pages + 1 or gap > n_pages or start >= n_pages)
+        throw std::runtime_error("checkpoint is truncated or corrupt");
+
+    // (a shorter remap period than the saved run's)
+    if (n_writes_since_move >= remap_period) n_writes_since_move = 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * The Start-Gap wear-leveling policy (Qureshi et al., MICRO '09): the N pages
+ * of memory live in N + 1 frames, one of which (the gap) is always empty.
+ * Every remap period writes, the page in the frame just below the gap is
+ * moved into it (costing one write of that page), moving the gap down by one;
+ * once the gap reaches frame 0, the page in frame N is moved there instead,
+ * and every page's frame has rotated by one (tracked by start). The mapping
+ * is then purely algebraic:
+ *     frame = (page + start) mod N, plus one if that's >= gap.
+ * Pages are taken in dense ID order, without the static address randomizer;
+ * the trace's first-touch order already spreads them. End of life is when a
+ * written frame reaches its endurance.
+ */
+#pragma once
+
+#include <cstdbool>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+#include "Checkpoint.h"
+#include "FrameQueues.h"
+#include "Policy.h"
+#include "WriteStream.h"
+
+
+class StartGap {
+    public:
+        StartGap(const write_stream_t& ws, const sim_config_t& cfg,
+                uint64_t n_pages_mem);
+        StartGap(const StartGap& sg) = delete;
+        StartGap& operator=(const StartGap& sg) = delete;
+        StartGap(StartGap&& sg) = delete;
+        StartGap& operator=(StartGap&& sg) = delete;
+        ~StartGap();
+
+        inline bool write(page_id_t p, uint64_t page_bfpw, uint64_t n_writes,
+                frame_idx_t& f);
+        inline uint64_t get_lifetime_bfs(frame_idx_t f);
+        uint64_t get_total_bfs();
+        void get_frame_wear(std::vector<uint64_t>& bfs);
+        void get_queue_sizes(std::vector<uint64_t>& queue_sizes);
+        inline uint64_t get_n_remaps();
+        inline const remap_t& get_last_remap();
+        uint64_t fast_forward(uint64_t max_n_passes,
+                frame_idx_t& most_written_frame);
+
+        void print_config();
+        void dump_config(std::stringstream& ss);
+        void dump_stats(std::stringstream& ss, frame_idx_t most_written_frame);
+        void save(Checkpoint& ckpt);
+        void load(Checkpoint& ckpt);
+
+        static uint64_t get_param(const sim_config_t& cfg);
+
+        static constexpr policy_t ID = POLICY_START_GAP;
+        static constexpr bool CAN_FAST_FORWARD = false;
+        static constexpr const char* PARAM_NAME = "REMAP_PERIOD_WRITES";
+        static constexpr const char* N_REMAPS_NAME = "TOTAL_N_GAP_MOVES";
+
+    private:
+        inline frame_idx_t get_frame(uint64_t page);
+        void move_gap();
+
+        const write_stream_t& ws;
+        uint64_t remap_period;
+        uint64_t frame_cap;
+        // n. pages in memory (i.e., N); pages >= ws.n_pages hold filler
+        uint64_t n_pages;
+
+        // internal mechanics
+        std::vector<uint64_t> frame_bfs;
+        uint64_t start = 0;
+        uint64_t gap;
+        uint64_t n_writes_since_move = 0;
+        uint64_t n_gap_moves = 0;
+        remap_t last_remap = {{NO_FRAME, NO_FRAME}, {0, 0}};
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline frame_idx_t
+StartGap::get_frame(uint64_t page)
+{
+    uint64_t f = page + start;
+    if (f >= n_pages) f -= n_pages;
+    if (f >= gap) ++f;
+    return f;
+}
+
+
+inline bool
+StartGap::write(page_id_t p, uint64_t page_bfpw, uint64_t n_writes,
+        frame_idx_t& f)
+{
+    f = get_frame(p);
+    frame_bfs[f] += page_bfpw;
+    bool alive = frame_bfs[f] < frame_cap;
+
+    n_writes_since_move += n_writes;
+    while (n_writes_since_move >= remap_period) {
+        n_writes_since_move -= remap_period;
+        move_gap();
+    }
+
+    return alive;
+}
+
+
+inline uint64_t
+StartGap::get_lifetime_bfs(frame_idx_t f)
+{
+    return frame_bfs[f];
+}
+
+
+inline uint64_t
+StartGap::get_n_remaps()
+{
+    return n_gap_moves;
+}
+
+
+inline const remap_t&
+StartGap::get_last_remap()
+{
+    return last_remap;
+}
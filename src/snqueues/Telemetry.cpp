@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include "Telemetry.h"
+
+
+Telemetry::Telemetry(const std::string& filepath, uint64_t interval_n_passes,
+        uint64_t n_frames, uint64_t frame_cap, uint64_t n_queues) :
+        interval_n_passes(interval_n_passes), n_queues(n_queues),
+        ofs(filepath, std::ofstream::out | std::ofstream::binary |
+        std::ofstream::trunc)
+{
+    if (!ofs.is_open())
+        throw std::runtime_error("could not open " + filepath);
+
+    uint64_t header[] = {MAGIC, VERSION, n_frames, frame_cap, n_queues,
+            N_PERCENTILES};
+    ofs.write((const char*) header, sizeof(header));
+    ofs.write((const char*) PERCENTILES, sizeof(PERCENTILES));
+
+    record_buf.resize(3 + N_PERCENTILES + n_queues);
+}
+
+
+Telemetry::~Telemetry()
+{
+}
+
+
+/*
+ * The percentiles are nearest-rank, each selected from what's left above the
+ * previous one, so that a snapshot is linear (and not n log n) in the n.
+ * frames.
+ */
+void
+Telemetry::record(uint64_t n_passes, double system_time_s, uint64_t n_remaps,
+        std::vector<uint64_t>& frame_bfs,
+        const std::vector<uint64_t>& queue_sizes)
+{
+    record_buf[0] = n_passes;
+    memcpy(&record_buf[1], &system_time_s, sizeof(system_time_s));
+    record_buf[2] = n_remaps;
+
+    auto first = frame_bfs.begin();
+    for (size_t i = 0; i < N_PERCENTILES; ++i) {
+        auto nth = frame_bfs.begin() + (size_t) std::llround(
+                PERCENTILES[i] / 100.0 * (frame_bfs.size() - 1));
+        std::nth_element(first, nth, frame_bfs.end());
+        record_buf[3 + i] = *nth;
+        first = nth;
+    }
+
+    std::copy(queue_sizes.begin(), queue_sizes.end(),
+            record_buf.begin() + 3 + N_PERCENTILES);
+    ofs.write((const char*) record_buf.data(),
+            record_buf.size() * sizeof(uint64_t));
+}
+
+
+void
+Telemetry::write_wear_map(const std::string& filepath,
+        const std::vector<uint64_t>& frame_bfs, uint64_t frame_cap)
+{
+    std::ofstream ofs(filepath, std::ofstream::out | std::ofstream::binary |
+            std::ofstream::trunc);
+    uint64_t header[] = {WEAR_MAP_MAGIC, VERSION, frame_bfs.size(),
+            frame_cap};
+    ofs.write((const char*) header, sizeof(header));
+    ofs.write((const char*) frame_bfs.data(),
+            frame_bfs.size() * sizeof(uint64_t));
+}
+
+
+uint64_t
+Telemetry::get_auto_interval(uint64_t n_frames, uint64_t n_writes)
+{
+    uint64_t n_snapshot_writes = n_frames * SNAPSHOT_WRITES_PER_FRAME *
+            AUTO_OVERHEAD_INV;
+    n_writes = std::max<uint64_t>(n_writes, 1);
+    return std::max<uint64_t>(1, (n_snapshot_writes + n_writes - 1) /
+            n_writes);
+}
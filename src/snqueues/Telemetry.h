@@ -0,0 +1,83 @@
+/*
+ * Wear telemetry for SNQueues: a time series of compact, fixed-size binary
+ * records, one every so many passes, each with percentiles of the frames'
+ * wear and (for policies with queues) every queue's occupancy; and, at
+ * termination, a per-frame wear map. Both files are a header of 8-byte
+ * fields followed by flat arrays of them, so that they can be mmapped (e.g.,
+ * with numpy.memmap) for plotting.
+ *
+ * Time series file: a header of
+ *     uint64 magic, version, n_frames, frame_cap, n_queues, n_percentiles
+ *     double percentiles[n_percentiles]
+ * then one record per snapshot of
+ *     uint64 n_passes; double system_time_s; uint64 n_remaps
+ *     uint64 percentile_bfs[n_percentiles]
+ *     uint64 queue_sizes[n_queues]
+ * Wear map file: a header of
+ *     uint64 magic, version, n_frames, frame_cap
+ * then uint64 lifetime_bfs[n_frames], by frame index (as in
+ * MOST_WRITTEN_FRAME_IDX).
+ */
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+
+class Telemetry {
+    public:
+        Telemetry(const std::string& filepath, uint64_t interval_n_passes,
+                uint64_t n_frames, uint64_t frame_cap, uint64_t n_queues);
+        Telemetry(const Telemetry& t) = delete;
+        Telemetry& operator=(const Telemetry& t) = delete;
+        Telemetry(Telemetry&& t) = delete;
+        Telemetry& operator=(Telemetry&& t) = delete;
+        ~Telemetry();
+
+        // append a snapshot after n_passes passes (reorders frame_bfs)
+        void record(uint64_t n_passes, double system_time_s,
+                uint64_t n_remaps, std::vector<uint64_t>& frame_bfs,
+                const std::vector<uint64_t>& queue_sizes);
+        inline uint64_t get_interval();
+
+        static void write_wear_map(const std::string& filepath,
+                const std::vector<uint64_t>& frame_bfs, uint64_t frame_cap);
+        static uint64_t get_auto_interval(uint64_t n_frames,
+                uint64_t n_writes);
+
+        // identify the formats; bump the version on any layout change
+        static constexpr uint64_t MAGIC = 0x31454c4554514e53;  // "SNQTELE1"
+        static constexpr uint64_t WEAR_MAP_MAGIC =
+                0x3150414d57514e53;  // "SNQWMAP1"
+        static constexpr uint64_t VERSION = 1;
+        static constexpr double PERCENTILES[] =
+                {0.0, 1.0, 5.0, 25.0, 50.0, 75.0, 95.0, 99.0, 99.9, 100.0};
+        static constexpr uint64_t N_PERCENTILES =
+                sizeof(PERCENTILES) / sizeof(PERCENTILES[0]);
+        // a snapshot costs about as much per frame as this many replayed
+        // writes; by default, take one every so many passes that snapshots
+        // add at most 1 / AUTO_OVERHEAD_INV of the replay's time
+        static constexpr uint64_t SNAPSHOT_WRITES_PER_FRAME = 4;
+        static constexpr uint64_t AUTO_OVERHEAD_INV = 50;
+
+    private:
+        uint64_t interval_n_passes;
+        uint64_t n_queues;
+
+        // internal mechanics
+        std::ofstream ofs;
+        // (one record's worth, reused)
+        std::vector<uint64_t> record_buf;
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline uint64_t
+Telemetry::get_interval()
+{
+    return interval_n_passes;
+}
@@ -0,0 +1,77 @@
+/*
+ * The trace, as decoded once by SNQueues for replay: its writes, in order, as
+ * dense page IDs with their bit flips per write folded in, plus the per-page
+ * tables the simulations need. Read-only once built, so any number of
+ * simulations (e.g., in a sweep) can replay it concurrently.
+ * NOTE: there is no corresponding .cpp file.
+ */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "FrameQueues.h"
+
+
+// one write in the stream; or, if the stream is coalesced, a run of writes
+// to the same page, with their bit flips summed (up to UINT16_MAX each)
+typedef struct {
+    page_id_t page;
+    // bits flipped per write for the page (at most bits per line)
+    uint16_t bfpw;
+    union {
+        // which line of the page
+        uint16_t line;
+        // (coalesced only) n. writes
+        uint16_t n_writes;
+    };
+} write_t;
+
+
+typedef struct write_stream_t {
+    std::vector<write_t> writes;
+    // cycle of each write (only if tracing promotion events; else empty)
+    std::vector<uint64_t> cycles;
+    uint64_t trace_end_cycle = 0;
+    // in super-frame mode, writes is coalesced: each page's writes within a
+    // pass (or migration window) are merged into as few records as fit, in
+    // the order of each record's first write; n_writes counts the writes
+    // either way
+    bool is_coalesced = false;
+    uint64_t n_writes = 0;
+
+    // pages are numbered densely in first-touch order, over reads and writes;
+    // one more ID past those (filler_page) stands for free frames' contents
+    uint64_t n_pages = 0;
+    page_id_t filler_page = 0;
+    // by page ID (including filler_page)
+    std::vector<uint64_t> page_bfpws;
+    // by page ID (excluding filler_page); only for fast-forwarding, else empty
+    std::vector<uint64_t> page_n_writes;
+    std::vector<uint64_t> page_first_write_idxs;
+    std::vector<uint64_t> page_last_write_idxs;
+
+    // in super-frame mode, the n. pages per (super-)page, and the largest
+    // share any one page takes of its super-page's bit flips per pass (or of
+    // a copy of it); as a page's frame then takes at most that share of its
+    // super-frame's wear, the page-level lifetime estimate is bounded by
+    //     est. / (max_page_share * pages_per_frame) <= page-level <= est.
+    // (for the same mapping, and hosting spans of whole passes)
+    uint64_t pages_per_frame = 1;
+    double max_page_share = 1.0;
+
+    // with a DRAM cache in front of the memory (else 0), its size, and the
+    // trace's writes to this stream's pages, which it filtered down to the
+    // dirty lines' write-backs in writes; of those, how many are the
+    // end-of-pass write-back of lines still dirty
+    uint64_t dram_cache_size = 0;
+    uint64_t n_trace_writes = 0;
+    uint64_t n_flush_writes = 0;
+
+    // (only for the migration cost model; else empty) by fixed windows of
+    // window_cycles trace cycles: the index of the window's first write, and
+    // its line accesses that reach the memory (i.e., its own traffic)
+    uint64_t window_cycles = 0;
+    std::vector<uint64_t> window_first_write_idxs;
+    std::vector<uint64_t> window_n_accesses;
+} write_stream_t;
@@ -1,8 +1,10 @@
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <unistd.h>
+#include <vector>
 
 #include "../common/util.h"
 #include "SNStats.h"
@@ -15,6 +17,18 @@ SNStats::SNStats(int argc, char* argv[])
 
     std::string memtrace_filepath = memtrace_directory + "/" + "memtrace.bin";
     mtr.load(memtrace_filepath);
+
+    if (window_cycles != 0) {
+        window_ofs.open("snstats-windows.bin",
+                std::ofstream::out | std::ofstream::binary);
+        uint64_t file_header[2] = {window_cycles, window_top_k};
+        window_ofs.write((char*) file_header, sizeof(file_header));
+    }
+
+    if (aggregation_mode == AGGREGATION_MODE_SORT) {
+        pool = std::make_unique<ThreadPool>();
+        line_write_aggregator = std::make_unique<SortAggregator>(*pool);
+    }
 }
 
 
@@ -35,9 +49,19 @@ SNStats::parse_and_validate_args(int argc, char* argv[])
     memtrace_directory = "";
     line_size = 0;
     page_size = 0;
+    // (optional; defaults to hashing)
+    aggregation_mode_str = "hash";
+    aggregation_mode = AGGREGATION_MODE_HASH;
+    // (optional; windowed tracking is off unless -w is supplied)
+    window_cycles = 0;
+    window_top_k = DEFAULT_WINDOW_TOP_K;
+    // (optional; interval tracking is off unless -i is supplied)
+    interval_top_n = 0;
+    // (optional)
+    line_util = 0;
 
     // parse
-    while ((c = getopt(argc, argv, "m:l:p:")) != -1) {
+    while ((c = getopt(argc, argv, "m:l:p:a:w:k:i:u:")) != -1) {
         try {
             switch (c) {
                 case 'm':
@@ -49,6 +73,29 @@ SNStats::parse_and_validate_args(int argc, char* argv[])
                 case 'p':
                     page_size = shorthand_to_integer(optarg, 1024);
                     break;
+                case 'a':
+                    aggregation_mode_str = optarg;
+                    std::transform(aggregation_mode_str.begin(),
+                            aggregation_mode_str.end(),
+                            aggregation_mode_str.begin(), ::tolower);
+                    if (aggregation_mode_str == "hash")
+                        aggregation_mode = AGGREGATION_MODE_HASH;
+                    else if (aggregation_mode_str == "sort")
+                        aggregation_mode = AGGREGATION_MODE_SORT;
+                    else aggregation_mode = AGGREGATION_MODE_INVALID;
+                    break;
+                case 'w':
+                    window_cycles = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'k':
+                    window_top_k = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'i':
+                    interval_top_n = shorthand_to_integer(optarg, 1000);
+                    break;
+                case 'u':
+                    line_util = string_to_boolean(optarg);
+                    break;
                 case '?':
                     print_message_and_die("unrecognized argument");
             }
@@ -84,34 +131,180 @@ SNStats::parse_and_validate_args(int argc, char* argv[])
     if (__builtin_popcountll(page_size) != 1)
         print_message_and_die("page size (-p) must be a power of 2");
 
+    if (aggregation_mode == AGGREGATION_MODE_INVALID)
+        print_message_and_die("aggregation mode (-a) must be hash or sort");
+
+    if (window_top_k == 0)
+        print_message_and_die("windowed top-K (-k) must be >= 1");
+
+    if (line_util == -1)
+        print_message_and_die("could not parse line utilization mode (-u)");
 
     lines_per_page = page_size / line_size;
 
     line_size_log2 = __builtin_ctzll(line_size);
     page_size_log2 = __builtin_ctzll(page_size);
+    bitmap_words_per_page = (lines_per_page + 63) / 64;
 }
 
 
 void
 SNStats::run()
 {
+    bool tracking = window_cycles != 0 or interval_top_n != 0 or line_util;
+    if (tracking) track_batch.reserve(TRACK_BATCH_SIZE);
+    double prev_tracking_time_s = tracking_time_s;
+    auto start_time = std::chrono::steady_clock::now();
+
     while (!mtr.is_end_of_pass()) {
         auto& mt = mtr.next();
+        bool is_write = mt.is_write;
+        if (!is_write) continue;
+
         line_addr_t line_addr = mt.line_addr;
         page_addr_t page_addr = line_addr_to_page_addr(line_addr,
                 line_size_log2, page_size_log2);
-        bool is_write = mt.is_write;
 
-        if (is_write) {
+        if (aggregation_mode == AGGREGATION_MODE_HASH) {
             ++line_write_counts[line_addr];
             ++page_write_counts[page_addr];
         }
+        else {
+            // just buffer the written line addrs.; page counts are derived
+            // from the (sorted) line counts in aggregate_stats()
+            line_write_aggregator->add(line_addr);
+        }
+
+        if (tracking) {
+            track_batch.push_back({mt.cycle, line_addr, page_addr});
+            if (track_batch.size() == TRACK_BATCH_SIZE) track_writes(false);
+        }
+    }
+
+    if (tracking) track_writes(true);
+
+    // (the trackers' time is reported apart, in TRACKING_TIME_S)
+    std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_time;
+    aggregation_time_s += elapsed.count() -
+            (tracking_time_s - prev_tracking_time_s);
+}
+
+
+/*
+ * Hand the batched writes, in trace order, to whichever of the window,
+ * interval and line-utilization trackers are on, timing them; at the end of
+ * the trace, also emit the final (partial) window.
+ */
+void
+SNStats::track_writes(bool end_of_trace)
+{
+    auto start_time = std::chrono::steady_clock::now();
+
+    for (auto& tw : track_batch) {
+        if (window_cycles != 0) track_window_write(tw.cycle, tw.page_addr);
+
+        if (interval_top_n != 0 or line_util) {
+            uint32_t page_id = get_page_id(tw.page_addr);
+            if (interval_top_n != 0) track_interval_write(page_id, tw.cycle);
+            if (line_util) track_line_write(page_id, tw.line_addr);
+        }
+    }
+    track_batch.clear();
+
+    if (end_of_trace and window_cycles != 0) flush_window();
+
+    std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_time;
+    tracking_time_s += elapsed.count();
+}
+
+
+/*
+ * Account a write to page_addr at the given cycle towards its time window,
+ * first emitting the current window if the write belongs to a later one.
+ * NOTE: trace cycles are not strictly ascending across cores; a write with a
+ * cycle that falls into an already-emitted window is attributed to the
+ * current window.
+ */
+void
+SNStats::track_window_write(uint64_t cycle, page_addr_t page_addr)
+{
+    uint64_t window_idx = cycle / window_cycles;
+
+    if (window_idx > curr_window_idx) {
+        flush_window();
+        curr_window_idx = window_idx;
     }
+
+    ++window_page_write_counts[page_addr];
+    ++curr_window_n_writes;
+}
+
+
+/*
+ * Write out the current window's record (see SNStats.h for the format), and
+ * reset the per-window state. Windows that saw no writes are skipped.
+ */
+void
+SNStats::flush_window()
+{
+    if (curr_window_n_writes == 0) return;
+
+    window_record_header_t h = {curr_window_idx, curr_window_n_writes,
+            window_page_write_counts.size()};
+    window_ofs.write((char*) &h, sizeof(h));
+
+    // select the top-K pages by writes
+    std::vector<window_page_t> top(window_page_write_counts.begin(),
+            window_page_write_counts.end());
+    size_t n_top = std::min(top.size(), (size_t) window_top_k);
+    std::partial_sort(top.begin(), top.begin() + n_top, top.end(),
+            [](const window_page_t& p0, const window_page_t& p1) {
+                return p0.second > p1.second;
+            }
+    );
+    // zero-pad up to K, so that all records have the same size
+    top.resize(window_top_k, {0, 0});
+
+    for (size_t i = 0; i < window_top_k; ++i) {
+        uint64_t pair[2] = {top[i].first, top[i].second};
+        window_ofs.write((char*) pair, sizeof(pair));
+    }
+
+    ++n_windows_emitted;
+    window_page_write_counts.clear();
+    curr_window_n_writes = 0;
 }
 
 
 void
 SNStats::aggregate_stats()
+{
+    auto start_time = std::chrono::steady_clock::now();
+
+    if (aggregation_mode == AGGREGATION_MODE_SORT) aggregate_stats_sort();
+    else aggregate_stats_hash();
+
+    std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_time;
+    aggregation_time_s += elapsed.count();
+
+    most_written_line_bytes_written = most_written_line_n_writes * line_size;
+    most_written_page_bytes_written = most_written_page_n_writes * line_size;
+
+    start_time = std::chrono::steady_clock::now();
+
+    if (interval_top_n != 0) dump_intervals();
+    if (line_util) aggregate_line_util_stats();
+
+    elapsed = std::chrono::steady_clock::now() - start_time;
+    tracking_time_s += elapsed.count();
+}
+
+
+void
+SNStats::aggregate_stats_hash()
 {
     // find the most-written line
     auto& mwl = *std::max_element(line_write_counts.begin(),
@@ -132,9 +325,136 @@ SNStats::aggregate_stats()
             }
     );
     most_written_page_n_writes = mwp.second;
+}
 
-    most_written_line_bytes_written = most_written_line_n_writes * line_size;
-    most_written_page_bytes_written = most_written_page_n_writes * line_size;
+
+void
+SNStats::aggregate_stats_sort()
+{
+    line_write_aggregator->finalize();
+    auto& line_counts = line_write_aggregator->get_counts();
+
+    // since page addrs. are line addrs. shifted right, coarsening the sorted
+    // line counts yields the page counts without a second sort
+    auto page_counts = SortAggregator::coarsen(line_counts,
+            page_size_log2 - line_size_log2);
+
+    auto count_cmp = [](const key_count_t& kc0, const key_count_t& kc1) {
+        return kc0.count < kc1.count;
+    };
+
+    // find the most-written line and page
+    most_written_line_n_writes = std::max_element(line_counts.begin(),
+            line_counts.end(), count_cmp)->count;
+    most_written_page_n_writes = std::max_element(page_counts.begin(),
+            page_counts.end(), count_cmp)->count;
+}
+
+
+/*
+ * Sum the interval histograms of the top-N most-written pages, and write both
+ * that and the global histogram to snstats-intervals.txt.
+ */
+void
+SNStats::dump_intervals()
+{
+    std::vector<uint32_t> top(page_n_writes.size());
+    for (uint32_t i = 0; i < top.size(); ++i) top[i] = i;
+
+    size_t n_top = std::min(top.size(), (size_t) interval_top_n);
+    std::partial_sort(top.begin(), top.begin() + n_top, top.end(),
+            [this](uint32_t p0, uint32_t p1) {
+                return page_n_writes[p0] > page_n_writes[p1];
+            }
+    );
+
+    std::array<uint64_t, N_INTERVAL_BUCKETS> top_interval_hist = {};
+    for (size_t i = 0; i < n_top; ++i) {
+        uint32_t hist_idx = page_interval_hist_idxs[top[i]];
+        if (hist_idx == NO_INTERVAL_HIST) continue;
+        for (size_t b = 0; b < N_INTERVAL_BUCKETS; ++b) {
+            top_interval_hist[b] +=
+                    interval_hist_arena[hist_idx * N_INTERVAL_BUCKETS + b];
+        }
+    }
+
+    std::ofstream ofs("snstats-intervals.txt", std::ofstream::out);
+    ofs << "MIN_CYCLES" << " " << "MAX_CYCLES" << " " << "ALL_PAGES" << " " <<
+            "TOP_" << interval_top_n << "_PAGES" << std::endl;
+    for (size_t b = 0; b < N_INTERVAL_BUCKETS; ++b) {
+        uint64_t lo = b == 0 ? 0 : (uint64_t) 1 << (b - 1);
+        uint64_t hi = b == 0 ? 0 : ((uint64_t) 1 << b) - 1;
+        // (last bucket is open-ended)
+        if (b == N_INTERVAL_BUCKETS - 1) hi = UINT64_MAX;
+        ofs << lo << " " << hi << " " << interval_hist[b] << " " <<
+                top_interval_hist[b] << std::endl;
+    }
+}
+
+
+/*
+ * For each written page, find how many of its lines were written, and the
+ * ratio of its most-written line's writes to the mean writes per line (1.0
+ * means writes are spread perfectly evenly; lines_per_page means all writes
+ * went to one line). Writes the lines-touched distribution to
+ * snstats-lineutil.txt.
+ */
+void
+SNStats::aggregate_line_util_stats()
+{
+    uint64_t n_pages = page_id_addrs.size();
+    if (n_pages == 0) return;
+
+    lines_touched_hist.assign(lines_per_page + 1, 0);
+    std::vector<double> ratios(n_pages);
+    uint64_t total_lines_touched = 0;
+    uint64_t total_writes = 0;
+    double weighted_ratio_sum = 0.0;
+
+    for (uint32_t p = 0; p < n_pages; ++p) {
+        uint64_t lines_touched = 0;
+        for (uint64_t w = 0; w < bitmap_words_per_page; ++w) {
+            lines_touched += __builtin_popcountll(
+                    line_bitmap_arena[p * bitmap_words_per_page + w]);
+        }
+        ++lines_touched_hist[lines_touched];
+        total_lines_touched += lines_touched;
+
+        uint64_t page_writes = 0;
+        uint64_t max_line_writes = 0;
+        for (uint64_t l = 0; l < lines_per_page; ++l) {
+            uint64_t line_writes = get_line_write_count(p, l);
+            page_writes += line_writes;
+            max_line_writes = std::max(max_line_writes, line_writes);
+        }
+
+        ratios[p] = (double) max_line_writes /
+                ((double) page_writes / (double) lines_per_page);
+        total_writes += page_writes;
+        weighted_ratio_sum += ratios[p] * (double) page_writes;
+    }
+
+    mean_lines_touched = (double) total_lines_touched / (double) n_pages;
+    weighted_max_mean_ratio = weighted_ratio_sum / (double) total_writes;
+
+    double ratio_sum = 0.0;
+    for (auto r : ratios) ratio_sum += r;
+    mean_max_mean_ratio = ratio_sum / (double) n_pages;
+
+    std::sort(ratios.begin(), ratios.end());
+    auto percentile = [&ratios](double p) {
+        return ratios[(size_t) (p * (double) (ratios.size() - 1))];
+    };
+    p50_max_mean_ratio = percentile(0.50);
+    p90_max_mean_ratio = percentile(0.90);
+    p99_max_mean_ratio = percentile(0.99);
+    max_max_mean_ratio = ratios.back();
+
+    std::ofstream ofs("snstats-lineutil.txt", std::ofstream::out);
+    ofs << "LINES_TOUCHED" << " " << "N_PAGES" << std::endl;
+    for (uint64_t i = 0; i <= lines_per_page; ++i) {
+        ofs << i << " " << lines_touched_hist[i] << std::endl;
+    }
 }
 
 
@@ -154,6 +474,36 @@ SNStats::dump_termination_stats()
             most_written_line_bytes_written << std::endl;
     ss << "MOST_WRITTEN_PAGE_BYTES_WRITTEN" << "  " <<
             most_written_page_bytes_written << std::endl;
+    ss << "AGGREGATION_MODE" << " " << aggregation_mode_str << std::endl;
+    ss << "AGGREGATION_TIME_S" << " " << aggregation_time_s << std::endl;
+    if (window_cycles != 0 or interval_top_n != 0 or line_util)
+        ss << "TRACKING_TIME_S" << " " << tracking_time_s << std::endl;
+    if (window_cycles != 0) {
+        ss << "WINDOW_CYCLES" << " " << window_cycles << std::endl;
+        ss << "WINDOW_TOP_K" << " " << window_top_k << std::endl;
+        ss << "N_WINDOWS" << " " << n_windows_emitted << std::endl;
+    }
+    if (interval_top_n != 0) {
+        ss << "INTERVAL_TOP_N" << " " << interval_top_n << std::endl;
+        ss << "PAGES_WRITTEN" << " " << page_id_addrs.size() << std::endl;
+    }
+    if (line_util) {
+        ss << "LINES_PER_PAGE" << " " << lines_per_page << std::endl;
+        ss << "MEAN_LINES_TOUCHED_PER_PAGE" << " " << mean_lines_touched <<
+                std::endl;
+        ss << "MAX_MEAN_LINE_WRITE_RATIO_MEAN" << " " << mean_max_mean_ratio <<
+                std::endl;
+        ss << "MAX_MEAN_LINE_WRITE_RATIO_WRITE_WEIGHTED" << " " <<
+                weighted_max_mean_ratio << std::endl;
+        ss << "MAX_MEAN_LINE_WRITE_RATIO_P50" << " " << p50_max_mean_ratio <<
+                std::endl;
+        ss << "MAX_MEAN_LINE_WRITE_RATIO_P90" << " " << p90_max_mean_ratio <<
+                std::endl;
+        ss << "MAX_MEAN_LINE_WRITE_RATIO_P99" << " " << p99_max_mean_ratio <<
+                std::endl;
+        ss << "MAX_MEAN_LINE_WRITE_RATIO_MAX" << " " << max_max_mean_ratio <<
+                std::endl;
+    }
 
     std::cout << ss.rdbuf()->str();
 
@@ -2,15 +2,38 @@
  * Basic simulation for multi-chip statistics; namely,
  * 1. percentage on- vs. off-chip accesses, and
  * 2. write imbalance between multiple nodes.
+ *
+ * Optionally (-w), also cuts the trace into fixed windows of cycles, and for
+ * each window records the top-K written pages to snstats-windows.bin. That
+ * file is a header of two uint64s (window size in cycles, K), followed by one
+ * fixed-size record per window that saw writes:
+ * - window_record_header_t (window index, n. writes, n. distinct pages), then
+ * - K pairs of uint64s (page addr., n. writes), descending by writes, and
+ *   zero-padded if the window wrote fewer than K pages.
+ *
+ * Optionally (-i), also tracks each page's last-write cycle and accumulates a
+ * log2-bucketed histogram of inter-write intervals, globally and over the
+ * top-N most-written pages, written to snstats-intervals.txt.
+ *
+ * Optionally (-u), also tracks which lines of each page are written, and how
+ * often, to report how evenly writes spread within pages (i.e., whether
+ * intra-page line rotation is worthwhile).
  */
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <fstream>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 
 #include "../common/defs.h"
 #include "../common/MemTraceReader.h"
+#include "../common/SortAggregator.h"
+#include "../common/ThreadPool.h"
 
 
 class SNStats {
@@ -28,26 +51,203 @@ class SNStats {
 
 
     private:
+        typedef enum {
+            AGGREGATION_MODE_HASH,
+            AGGREGATION_MODE_SORT,
+            AGGREGATION_MODE_INVALID
+        } aggregation_mode_t;
+
+        typedef struct __attribute__((packed)) {
+            uint64_t window_idx;
+            uint64_t n_writes;
+            uint64_t n_distinct_pages;
+        } window_record_header_t;
+
+        typedef std::pair<page_addr_t, uint64_t> window_page_t;
+
+        typedef struct {
+            uint64_t cycle;
+            line_addr_t line_addr;
+            page_addr_t page_addr;
+        } tracked_write_t;
+
         void parse_and_validate_args(int argc, char* argv[]);
+        void aggregate_stats_hash();
+        void aggregate_stats_sort();
+        void track_writes(bool end_of_trace);
+        void track_window_write(uint64_t cycle, page_addr_t page_addr);
+        void flush_window();
+        inline uint32_t get_page_id(page_addr_t page_addr);
+        inline void track_interval_write(uint32_t page_id, uint64_t cycle);
+        void dump_intervals();
+        inline void track_line_write(uint32_t page_id, line_addr_t line_addr);
+        inline uint32_t get_line_write_count(uint32_t page_id,
+                uint64_t line_idx);
+        void aggregate_line_util_stats();
+
+        // writes are handed to the trackers (-w, -i, -u) in batches of this
+        // many, so that their time is measured apart from the aggregation's
+        static constexpr size_t TRACK_BATCH_SIZE = 4096;
+        static constexpr uint64_t DEFAULT_WINDOW_TOP_K = 16;
+        // bucket i >= 1 holds intervals in [2^(i-1), 2^i) cycles; the last
+        // bucket also absorbs anything longer
+        static constexpr size_t N_INTERVAL_BUCKETS = 40;
+        static constexpr uint32_t NO_INTERVAL_HIST = UINT32_MAX;
+        static constexpr uint32_t NO_WIDE_LINE_COUNTS = UINT32_MAX;
 
         // input arguments
         std::string memtrace_directory;
         uint64_t line_size;
         uint64_t page_size;
+        std::string aggregation_mode_str;
+        aggregation_mode_t aggregation_mode;
+        uint64_t window_cycles;
+        uint64_t window_top_k;
+        uint64_t interval_top_n;
+        int line_util;
 
         // derived, or from input files
         MemTraceReader mtr;
         uint64_t lines_per_page;
         uint64_t line_size_log2;
         uint64_t page_size_log2;
+        uint64_t bitmap_words_per_page;
 
         // internal mechanics
         std::unordered_map<page_addr_t, uint64_t> page_write_counts;
         std::unordered_map<line_addr_t, uint64_t> line_write_counts;
+        // only used in AGGREGATION_MODE_SORT
+        std::unique_ptr<ThreadPool> pool;
+        std::unique_ptr<SortAggregator> line_write_aggregator;
+        // only used if any tracking is on; the writes not yet tracked
+        std::vector<tracked_write_t> track_batch;
+        // only used in windowed mode; holds just the current window's pages
+        std::unordered_map<page_addr_t, uint64_t> window_page_write_counts;
+        uint64_t curr_window_idx = 0;
+        uint64_t curr_window_n_writes = 0;
+        std::ofstream window_ofs;
+        // dense page IDs, assigned in order of first write; the per-page
+        // arrays below are indexed by them
+        std::unordered_map<page_addr_t, uint32_t> page_ids;
+        std::vector<page_addr_t> page_id_addrs;
+        // only used in interval mode. per-page histograms live in one flat
+        // arena, and are only allocated on a page's second write
+        std::vector<uint64_t> page_last_write_cycles;
+        std::vector<uint64_t> page_n_writes;
+        std::vector<uint32_t> page_interval_hist_idxs;
+        std::vector<uint32_t> interval_hist_arena;
+        std::array<uint64_t, N_INTERVAL_BUCKETS> interval_hist = {};
+        // only used in line-utilization mode. each page gets a bitmap of
+        // lines written, and 16-bit per-line write counters; a page whose
+        // counter would overflow is moved over to 32-bit counters
+        std::vector<uint64_t> line_bitmap_arena;
+        std::vector<uint16_t> line_count_arena;
+        std::vector<uint32_t> page_wide_line_count_idxs;
+        std::vector<uint32_t> wide_line_count_arena;
 
         // stats
         uint64_t most_written_line_n_writes = 0;
         uint64_t most_written_page_n_writes = 0;
         uint64_t most_written_line_bytes_written = 0;
         uint64_t most_written_page_bytes_written = 0;
+        double aggregation_time_s = 0.0;
+        double tracking_time_s = 0.0;
+        uint64_t n_windows_emitted = 0;
+        std::vector<uint64_t> lines_touched_hist;
+        double mean_lines_touched = 0.0;
+        double mean_max_mean_ratio = 0.0;
+        double weighted_max_mean_ratio = 0.0;
+        double p50_max_mean_ratio = 0.0;
+        double p90_max_mean_ratio = 0.0;
+        double p99_max_mean_ratio = 0.0;
+        double max_max_mean_ratio = 0.0;
 };
+
+
+/*
+ * Inline function definitions.
+ */
+inline uint32_t
+SNStats::get_page_id(page_addr_t page_addr)
+{
+    auto it = page_ids.find(page_addr);
+    if (it != page_ids.end()) return it->second;
+
+    uint32_t page_id = page_id_addrs.size();
+    page_ids.emplace(page_addr, page_id);
+    page_id_addrs.emplace_back(page_addr);
+
+    if (interval_top_n != 0) {
+        page_last_write_cycles.emplace_back(0);
+        page_n_writes.emplace_back(0);
+        page_interval_hist_idxs.emplace_back(NO_INTERVAL_HIST);
+    }
+
+    if (line_util) {
+        line_bitmap_arena.resize(line_bitmap_arena.size() +
+                bitmap_words_per_page, 0);
+        line_count_arena.resize(line_count_arena.size() + lines_per_page, 0);
+        page_wide_line_count_idxs.emplace_back(NO_WIDE_LINE_COUNTS);
+    }
+
+    return page_id;
+}
+
+
+inline void
+SNStats::track_interval_write(uint32_t page_id, uint64_t cycle)
+{
+    if (page_n_writes[page_id]++ != 0) {
+        // NOTE: cycles are not strictly ascending across cores; treat a
+        // "negative" interval as zero
+        uint64_t last = page_last_write_cycles[page_id];
+        uint64_t interval = cycle > last ? cycle - last : 0;
+        size_t bucket = interval == 0 ? 0 : 64 - __builtin_clzll(interval);
+        bucket = std::min(bucket, N_INTERVAL_BUCKETS - 1);
+
+        uint32_t& hist_idx = page_interval_hist_idxs[page_id];
+        if (hist_idx == NO_INTERVAL_HIST) {
+            hist_idx = interval_hist_arena.size() / N_INTERVAL_BUCKETS;
+            interval_hist_arena.resize(interval_hist_arena.size() +
+                    N_INTERVAL_BUCKETS, 0);
+        }
+
+        ++interval_hist_arena[hist_idx * N_INTERVAL_BUCKETS + bucket];
+        ++interval_hist[bucket];
+    }
+
+    page_last_write_cycles[page_id] = cycle;
+}
+
+
+inline void
+SNStats::track_line_write(uint32_t page_id, line_addr_t line_addr)
+{
+    uint64_t line_idx = line_addr & (lines_per_page - 1);
+
+    line_bitmap_arena[page_id * bitmap_words_per_page + (line_idx / 64)] |=
+            (uint64_t) 1 << (line_idx % 64);
+
+    uint32_t& wide_idx = page_wide_line_count_idxs[page_id];
+    uint16_t* counts = &line_count_arena[page_id * lines_per_page];
+
+    if (wide_idx == NO_WIDE_LINE_COUNTS and counts[line_idx] == UINT16_MAX) {
+        // widen this page's counters
+        wide_idx = wide_line_count_arena.size() / lines_per_page;
+        wide_line_count_arena.insert(wide_line_count_arena.end(), counts,
+                counts + lines_per_page);
+    }
+
+    if (wide_idx == NO_WIDE_LINE_COUNTS) ++counts[line_idx];
+    else ++wide_line_count_arena[wide_idx * lines_per_page + line_idx];
+}
+
+
+inline uint32_t
+SNStats::get_line_write_count(uint32_t page_id, uint64_t line_idx)
+{
+    uint32_t wide_idx = page_wide_line_count_idxs[page_id];
+    if (wide_idx == NO_WIDE_LINE_COUNTS)
+        return line_count_arena[page_id * lines_per_page + line_idx];
+    return wide_line_count_arena[wide_idx * lines_per_page + line_idx];
+}
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+#include "../common/util.h"
+#include "StackDist.h"
+
+
+
+StackDist::StackDist(int argc, char* argv[])
+{
+    parse_and_validate_args(argc, argv);
+
+    std::string memtrace_filepath = memtrace_directory + "/" + "memtrace.bin";
+    mtr.load(memtrace_filepath);
+}
+
+
+StackDist::~StackDist()
+{
+}
+
+
+void
+StackDist::parse_and_validate_args(int argc, char* argv[])
+{
+    int c;
+    optind = 0; // global: clear previous getopt() state, if any
+    opterr = 0; // global: don't explicitly warn on unrecognized args
+    int n_args_parsed = 0;
+
+    // sentinels
+    memtrace_directory = "";
+    line_size = 0;
+    page_size = 0;
+
+    // parse
+    while ((c = getopt(argc, argv, "m:l:p:")) != -1) {
+        try {
+            switch (c) {
+                case 'm':
+                    memtrace_directory = optarg;
+                    break;
+                case 'l':
+                    line_size = shorthand_to_integer(optarg, 1024);
+                    break;
+                case 'p':
+                    page_size = shorthand_to_integer(optarg, 1024);
+                    break;
+                case '?':
+                    print_message_and_die("unrecognized argument");
+            }
+        }
+        catch (...) {
+            print_message_and_die("generic arg parse failure");
+        }
+        ++n_args_parsed;
+    }
+
+
+    // and validate
+    // the executable itself (1) plus each arg matched w/its preceding flag (*2)
+    int argc_expected = 1 + (2 * n_args_parsed);
+    if (argc != argc_expected)
+        print_message_and_die("each argument must be accompanied by a flag");
+
+    if (memtrace_directory == "")
+        print_message_and_die("must supply MemTrace input directory (-m)");
+
+    if (line_size == 0)
+        print_message_and_die("must supply line size (-l)");
+
+    if (page_size == 0)
+        print_message_and_die("must supply page size (-p)");
+
+    if (line_size > page_size)
+        print_message_and_die("line size (-l) must be <= page size (-p)");
+
+    if (__builtin_popcountll(line_size) != 1)
+        print_message_and_die("line size (-l) must be a power of 2");
+
+    if (__builtin_popcountll(page_size) != 1)
+        print_message_and_die("page size (-p) must be a power of 2");
+
+
+    line_size_log2 = __builtin_ctzll(line_size);
+    page_size_log2 = __builtin_ctzll(page_size);
+}
+
+
+void
+StackDist::run()
+{
+    while (!mtr.is_end_of_pass()) {
+        auto& mt = mtr.next();
+        line_addr_t line_addr = mt.line_addr;
+        page_addr_t page_addr = line_addr_to_page_addr(line_addr,
+                line_size_log2, page_size_log2);
+        bool is_write = mt.is_write;
+
+        line_profiler.access(line_addr, is_write);
+        page_profiler.access(page_addr, is_write);
+    }
+}
+
+
+void
+StackDist::dump_termination_stats()
+{
+    line_profiler.dump_mrc("stackdist-line-mrc.txt", line_size);
+    page_profiler.dump_mrc("stackdist-page-mrc.txt", page_size);
+
+    // using a stringstream, dump to both file and stdout
+    std::stringstream ss;
+
+    ss << "LINE_SIZE" << " " << line_size << std::endl;
+    ss << "PAGE_SIZE" << " " << page_size << std::endl;
+    ss << "N_READS" << " " << line_profiler.get_n_reads() << std::endl;
+    ss << "N_WRITES" << " " << line_profiler.get_n_writes() << std::endl;
+    ss << "LINE_FOOTPRINT" << " " << line_profiler.get_footprint() <<
+            std::endl;
+    ss << "PAGE_FOOTPRINT" << " " << page_profiler.get_footprint() <<
+            std::endl;
+    ss << "LINE_COLD_READS" << " " << line_profiler.get_n_cold_reads() <<
+            std::endl;
+    ss << "LINE_COLD_WRITES" << " " << line_profiler.get_n_cold_writes() <<
+            std::endl;
+    ss << "PAGE_COLD_READS" << " " << page_profiler.get_n_cold_reads() <<
+            std::endl;
+    ss << "PAGE_COLD_WRITES" << " " << page_profiler.get_n_cold_writes() <<
+            std::endl;
+
+    std::cout << ss.rdbuf()->str();
+
+    std::ofstream ofs("stackdist.txt", std::ofstream::out);
+    ofs << ss.rdbuf()->str();
+}
+
+
+int
+main(int argc, char* argv[])
+{
+    StackDist sd(argc, argv);
+
+    sd.run();
+    sd.dump_termination_stats();
+
+    return 0;
+}
@@ -0,0 +1,47 @@
+/*
+ * Computes exact LRU stack (reuse) distances for every access in a trace, in a
+ * single pass, at both line and page granularity. From these, outputs the full
+ * miss-ratio curve of a fully-associative LRU cache of any size, separately
+ * for reads and writes; e.g., to size the LLC in RRLLC without re-simulating
+ * once per candidate size.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "../common/defs.h"
+#include "../common/MemTraceReader.h"
+#include "StackProfiler.h"
+
+
+class StackDist {
+    public:
+        StackDist(int argc, char* argv[]);
+        StackDist(const StackDist& sd) = delete;
+        StackDist& operator=(const StackDist& sd) = delete;
+        StackDist(StackDist&& sd) = delete;
+        StackDist& operator=(StackDist&& sd) = delete;
+        ~StackDist();
+
+        void run();
+        void dump_termination_stats();
+
+
+    private:
+        void parse_and_validate_args(int argc, char* argv[]);
+
+        // input arguments
+        std::string memtrace_directory;
+        uint64_t line_size;
+        uint64_t page_size;
+
+        // derived, or from input files
+        MemTraceReader mtr;
+        uint64_t line_size_log2;
+        uint64_t page_size_log2;
+
+        // internal mechanics
+        StackProfiler line_profiler;
+        StackProfiler page_profiler;
+};
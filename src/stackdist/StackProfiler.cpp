@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "StackProfiler.h"
+
+
+StackProfiler::StackProfiler()
+{
+}
+
+
+StackProfiler::~StackProfiler()
+{
+}
+
+
+/*
+ * Renumber the live timestamps (one per distinct address) densely as
+ * [0, n. live), preserving their order, and rebuild the Fenwick tree with
+ * room for at least as many new accesses again.
+ */
+void
+StackProfiler::compact()
+{
+    std::vector<std::pair<uint64_t, uint64_t*>> live;
+    live.reserve(last_access.size());
+    for (auto& kv : last_access) live.emplace_back(kv.second, &kv.second);
+    std::sort(live.begin(), live.end());
+
+    for (uint64_t i = 0; i < live.size(); ++i) *live[i].second = i;
+    now = live.size();
+
+    capacity = std::max(2 * now, MIN_CAPACITY);
+    tree.assign(capacity + 1, 0);
+
+    // linear-time Fenwick build with marks at [0, now)
+    for (uint64_t i = 1; i <= capacity; ++i) {
+        if (i <= now) tree[i] += 1;
+        uint64_t parent = i + (i & -i);
+        if (parent <= capacity) tree[parent] += tree[i];
+    }
+}
+
+
+/*
+ * Write the miss-ratio curve of a fully-associative LRU cache. One row is
+ * emitted per cache size at which the curve steps down; the miss ratio holds
+ * until the next row. Cold (first-touch) accesses always miss.
+ */
+void
+StackProfiler::dump_mrc(const std::string& filepath, uint64_t entry_size)
+{
+    std::ofstream ofs(filepath, std::ofstream::out);
+
+    ofs << "SIZE_ENTRIES" << " " << "SIZE_BYTES" << " " << "RD_MISS_RATIO" <<
+            " " << "WR_MISS_RATIO" << " " << "MISS_RATIO" << std::endl;
+
+    // misses at size 0 are every access; each distance d then turns into a
+    // hit from size d + 1 onwards
+    uint64_t rd_misses = n_reads;
+    uint64_t wr_misses = n_writes;
+    size_t max_dist = std::max(rd_hist.size(), wr_hist.size());
+
+    auto ratio = [](uint64_t misses, uint64_t accesses) {
+        return accesses == 0 ? 0.0 : (double) misses / (double) accesses;
+    };
+
+    for (size_t size = 0; size <= max_dist; ++size) {
+        if (size != 0) {
+            uint64_t rd = size - 1 < rd_hist.size() ? rd_hist[size - 1] : 0;
+            uint64_t wr = size - 1 < wr_hist.size() ? wr_hist[size - 1] : 0;
+            if (rd == 0 and wr == 0) continue;
+            rd_misses -= rd;
+            wr_misses -= wr;
+        }
+
+        ofs << size << " " << size * entry_size << " " <<
+                ratio(rd_misses, n_reads) << " " <<
+                ratio(wr_misses, n_writes) << " " <<
+                ratio(rd_misses + wr_misses, n_reads + n_writes) << std::endl;
+    }
+}
+
+
+uint64_t
+StackProfiler::get_n_reads()
+{
+    return n_reads;
+}
+
+
+uint64_t
+StackProfiler::get_n_writes()
+{
+    return n_writes;
+}
+
+
+uint64_t
+StackProfiler::get_n_cold_reads()
+{
+    return n_cold_reads;
+}
+
+
+uint64_t
+StackProfiler::get_n_cold_writes()
+{
+    return n_cold_writes;
+}
+
+
+uint64_t
+StackProfiler::get_footprint()
+{
+    return last_access.size();
+}
@@ -0,0 +1,115 @@
+/*
+ * Helper class for StackDist: computes exact LRU stack (reuse) distances for a
+ * stream of accesses at a single granularity (lines or pages).
+ *
+ * Each address remembers the timestamp of its last access, and a Fenwick tree
+ * over timestamps marks which timestamps are still some address' most recent
+ * access. The stack distance of an access is then the number of marks between
+ * the address' previous access and now, which takes O(log n) per access. When
+ * the timestamp space fills up, live timestamps are renumbered densely
+ * (amortized O(log n) per access), so the tree stays proportional to the
+ * footprint rather than to the trace length.
+ * NOTE: most functions are declared inline and defined in this .h file.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+class StackProfiler {
+    public:
+        StackProfiler();
+        StackProfiler(const StackProfiler& sp) = delete;
+        StackProfiler& operator=(const StackProfiler& sp) = delete;
+        StackProfiler(StackProfiler&& sp) = default;
+        StackProfiler& operator=(StackProfiler&& sp) = default;
+        ~StackProfiler();
+
+        inline void access(uint64_t addr, bool is_write);
+        void dump_mrc(const std::string& filepath, uint64_t entry_size);
+
+        uint64_t get_n_reads();
+        uint64_t get_n_writes();
+        uint64_t get_n_cold_reads();
+        uint64_t get_n_cold_writes();
+        uint64_t get_footprint();
+
+    private:
+        void compact();
+        inline void fenwick_add(uint64_t t, int32_t delta);
+        inline uint64_t fenwick_prefix(uint64_t t);
+
+        // minimum n. timestamps between compactions
+        static constexpr uint64_t MIN_CAPACITY = 1048576;
+
+        // addr -> timestamp of its most recent access
+        std::unordered_map<uint64_t, uint64_t> last_access;
+        // 1-indexed Fenwick tree over timestamps [0, capacity)
+        std::vector<uint32_t> tree;
+        uint64_t capacity = 0;
+        uint64_t now = 0;
+
+        // stack distance histograms; a hit in an LRU cache of N entries
+        // iff distance < N
+        std::vector<uint64_t> rd_hist;
+        std::vector<uint64_t> wr_hist;
+        uint64_t n_reads = 0;
+        uint64_t n_writes = 0;
+        uint64_t n_cold_reads = 0;
+        uint64_t n_cold_writes = 0;
+};
+
+
+/*
+ * Inline function definitions.
+ */
+inline void
+StackProfiler::fenwick_add(uint64_t t, int32_t delta)
+{
+    for (uint64_t i = t + 1; i <= capacity; i += i & -i) tree[i] += delta;
+}
+
+
+/*
+ * Number of marked timestamps in [0, t].
+ */
+inline uint64_t
+StackProfiler::fenwick_prefix(uint64_t t)
+{
+    uint64_t sum = 0;
+    for (uint64_t i = t + 1; i > 0; i -= i & -i) sum += tree[i];
+    return sum;
+}
+
+
+inline void
+StackProfiler::access(uint64_t addr, bool is_write)
+{
+    if (now == capacity) compact();
+
+    is_write ? ++n_writes : ++n_reads;
+
+    auto it = last_access.find(addr);
+    if (it == last_access.end()) {
+        // first touch: infinite stack distance
+        is_write ? ++n_cold_writes : ++n_cold_reads;
+        last_access.emplace(addr, now);
+    }
+    else {
+        uint64_t prev = it->second;
+        // distinct addrs. touched in (prev, now); now itself isn't marked yet
+        uint64_t dist = fenwick_prefix(now - 1) - fenwick_prefix(prev);
+        fenwick_add(prev, -1);
+        it->second = now;
+
+        auto& hist = is_write ? wr_hist : rd_hist;
+        if (dist >= hist.size()) hist.resize(dist + 1);
+        ++hist[dist];
+    }
+
+    fenwick_add(now, 1);
+    ++now;
+}